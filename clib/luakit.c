@@ -30,11 +30,15 @@
 #include "luah.h"
 #include "log.h"
 #include "web_context.h"
+#include "widgets/image.h"
 #include "globalconf.h"
 
+#include <errno.h>
 #include <glib.h>
 #include <gtk/gtk.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/wait.h>
 #include <time.h>
 #include <webkit2/webkit2.h>
@@ -191,6 +195,333 @@ luaH_luakit_save_file(lua_State *L)
     return 1;
 }
 
+/** Default time, in milliseconds, over which writes to the same file are
+ * coalesced by luakit.save_file_async() */
+#define FILE_WRITE_DEFAULT_DELAY 500
+
+/** A pending or in-progress asynchronous file write */
+typedef struct _file_write_t {
+    gchar *path;
+    GByteArray *contents;
+    /** Whether the contents are appended to the file instead of replacing it */
+    gboolean append;
+    guint timeout_id;
+    GError *error;
+} file_write_t;
+
+/** Pending file writes, keyed by path; writes are removed from the table when
+ * they are handed to the writer thread */
+static GHashTable *file_writes;
+/** Single writer thread, so writes to the same path land in order */
+static GThreadPool *file_write_pool;
+static GMutex file_write_lock;
+static GCond file_write_cond;
+/** Number of writes handed to the writer thread, keyed by path; protected by
+ * file_write_lock */
+static GHashTable *file_writes_in_flight;
+
+static void
+file_write_free(file_write_t *fw)
+{
+    if (fw->timeout_id)
+        g_source_remove(fw->timeout_id);
+    if (fw->error)
+        g_error_free(fw->error);
+    g_byte_array_unref(fw->contents);
+    g_free(fw->path);
+    g_slice_free(file_write_t, fw);
+}
+
+/* Report the result of a write on the main thread */
+static gboolean
+file_write_done(file_write_t *fw)
+{
+    if (fw->error)
+        warn("unable to save '%s': %s", fw->path, fw->error->message);
+    file_write_free(fw);
+    return FALSE;
+}
+
+static void
+file_append(file_write_t *fw)
+{
+    FILE *f = fopen(fw->path, "ab");
+    gboolean ok = f != NULL;
+    if (ok)
+        ok = fwrite(fw->contents->data, 1, fw->contents->len, f) == fw->contents->len;
+    gint err = errno;
+    if (f && fclose(f) != 0 && ok) {
+        ok = FALSE;
+        err = errno;
+    }
+    if (!ok)
+        g_set_error(&fw->error, G_FILE_ERROR, g_file_error_from_errno(err),
+                "%s", g_strerror(err));
+}
+
+static void
+file_write_thread(file_write_t *fw, gpointer UNUSED(user_data))
+{
+    if (fw->append)
+        file_append(fw);
+    else /* Writes to a temporary file and renames it into place */
+        g_file_set_contents(fw->path, (gchar*)fw->contents->data ?: "",
+                fw->contents->len, &fw->error);
+
+    g_mutex_lock(&file_write_lock);
+    guint n = GPOINTER_TO_UINT(g_hash_table_lookup(file_writes_in_flight, fw->path));
+    if (n > 1)
+        g_hash_table_insert(file_writes_in_flight, g_strdup(fw->path), GUINT_TO_POINTER(n - 1));
+    else
+        g_hash_table_remove(file_writes_in_flight, fw->path);
+    g_cond_broadcast(&file_write_cond);
+    g_mutex_unlock(&file_write_lock);
+
+    g_idle_add((GSourceFunc)file_write_done, fw);
+}
+
+static gboolean
+file_write_submit(file_write_t *fw)
+{
+    fw->timeout_id = 0;
+    g_hash_table_steal(file_writes, fw->path);
+
+    if (!file_write_pool) {
+        file_write_pool = g_thread_pool_new((GFunc)file_write_thread, NULL, 1, FALSE, NULL);
+        file_writes_in_flight = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    }
+
+    g_mutex_lock(&file_write_lock);
+    guint n = GPOINTER_TO_UINT(g_hash_table_lookup(file_writes_in_flight, fw->path));
+    g_hash_table_insert(file_writes_in_flight, g_strdup(fw->path), GUINT_TO_POINTER(n + 1));
+    g_mutex_unlock(&file_write_lock);
+    g_thread_pool_push(file_write_pool, fw, NULL);
+    return FALSE;
+}
+
+/** Writes any pending asynchronous writes to a path, and waits for all
+ * writes to that path to complete.
+ *
+ * \param path The path to flush, or \c NULL to flush all paths.
+ */
+void
+luakit_lib_flush_file_writes(const gchar *path)
+{
+    if (!file_writes)
+        return;
+
+    GList *pending = path ? NULL : g_hash_table_get_values(file_writes);
+    if (path) {
+        file_write_t *fw = g_hash_table_lookup(file_writes, path);
+        if (fw)
+            pending = g_list_prepend(pending, fw);
+    }
+    for (GList *l = pending; l; l = l->next) {
+        file_write_t *fw = l->data;
+        g_source_remove(fw->timeout_id);
+        file_write_submit(fw);
+    }
+    g_list_free(pending);
+
+    if (!file_writes_in_flight)
+        return;
+    g_mutex_lock(&file_write_lock);
+    while (path ? g_hash_table_contains(file_writes_in_flight, path)
+                : g_hash_table_size(file_writes_in_flight) > 0)
+        g_cond_wait(&file_write_cond, &file_write_lock);
+    g_mutex_unlock(&file_write_lock);
+}
+
+/** Atomically replaces the contents of a file on a background thread.
+ * Repeated writes to the same path within the delay are coalesced, so that
+ * only the most recent contents are written.
+ *
+ * \param  L The Lua VM state.
+ * \return   The number of elements pushed on stack (0).
+ *
+ * \luastack
+ * \lparam path     The path of the file to write.
+ * \lparam contents The new contents of the file.
+ * \lparam delay    Optional time in milliseconds to wait for further writes.
+ */
+static void
+file_write_queue(const gchar *path, const gchar *contents, size_t len, gboolean append, gint delay)
+{
+    if (!file_writes)
+        file_writes = g_hash_table_new(g_str_hash, g_str_equal);
+
+    file_write_t *fw = g_hash_table_lookup(file_writes, path);
+    if (fw) {
+        /* Coalesce with the pending write; appending to a pending write
+         * keeps its mode, since the result is the same */
+        if (!append) {
+            g_byte_array_set_size(fw->contents, 0);
+            fw->append = FALSE;
+        }
+        g_byte_array_append(fw->contents, (const guint8*)contents, len);
+        return;
+    }
+
+    fw = g_slice_new0(file_write_t);
+    fw->path = g_strdup(path);
+    fw->contents = g_byte_array_sized_new(len);
+    g_byte_array_append(fw->contents, (const guint8*)contents, len);
+    fw->append = append;
+    g_hash_table_insert(file_writes, fw->path, fw);
+    if (delay > 0)
+        fw->timeout_id = g_timeout_add(delay, (GSourceFunc)file_write_submit, fw);
+    else
+        file_write_submit(fw);
+}
+
+static gint
+luaH_luakit_save_file_async(lua_State *L)
+{
+    const gchar *path = luaL_checkstring(L, 1);
+    size_t len;
+    const gchar *contents = luaL_checklstring(L, 2, &len);
+    gint delay = luaL_optinteger(L, 3, FILE_WRITE_DEFAULT_DELAY);
+    file_write_queue(path, contents, len, FALSE, delay);
+    return 0;
+}
+
+/** Appends to a file on a background thread; pending writes to the same
+ * path are coalesced as with luakit.save_file_async().
+ *
+ * \param  L The Lua VM state.
+ * \return   The number of elements pushed on stack (0).
+ *
+ * \luastack
+ * \lparam path     The path of the file to append to.
+ * \lparam contents The data to append.
+ * \lparam delay    Optional time in milliseconds to wait for further writes.
+ */
+static gint
+luaH_luakit_append_file_async(lua_State *L)
+{
+    const gchar *path = luaL_checkstring(L, 1);
+    size_t len;
+    const gchar *contents = luaL_checklstring(L, 2, &len);
+    gint delay = luaL_optinteger(L, 3, FILE_WRITE_DEFAULT_DELAY);
+    file_write_queue(path, contents, len, TRUE, delay);
+    return 0;
+}
+
+/** Writes pending asynchronous file writes and waits for them to finish.
+ *
+ * \param  L The Lua VM state.
+ * \return   The number of elements pushed on stack (0).
+ *
+ * \luastack
+ * \lparam path Optional path to flush; if omitted, all files are flushed.
+ */
+static gint
+luaH_luakit_flush_file_writes(lua_State *L)
+{
+    luakit_lib_flush_file_writes(luaL_optstring(L, 1, NULL));
+    return 0;
+}
+
+/* Check that a value only contains plain data, which can be stored on disk */
+static void
+luaH_check_plain_data(lua_State *L, gint idx, gint depth)
+{
+    switch (lua_type(L, idx)) {
+      case LUA_TNIL:
+      case LUA_TNUMBER:
+      case LUA_TBOOLEAN:
+      case LUA_TSTRING:
+        return;
+      case LUA_TTABLE:
+        if (depth >= 100)
+            luaL_error(L, "cannot serialize table: nested too deeply or cyclic");
+        idx = luaH_absindex(L, idx);
+        luaL_checkstack(L, 3, NULL);
+        lua_pushnil(L);
+        while (lua_next(L, idx)) {
+            luaH_check_plain_data(L, -2, depth + 1);
+            luaH_check_plain_data(L, -1, depth + 1);
+            lua_pop(L, 1);
+        }
+        return;
+      default:
+        luaL_error(L, "cannot serialize value of type %s", luaL_typename(L, idx));
+    }
+}
+
+/** Serializes plain data values (nil, numbers, booleans, strings and tables
+ * of these) into a compact binary string. Each value becomes a separate,
+ * length-prefixed record, so serialized strings can be concatenated and
+ * appended to files.
+ *
+ * \param  L The Lua VM state.
+ * \return   The number of elements pushed on stack (1).
+ *
+ * \luastack
+ * \lparam ...   The values to serialize.
+ * \lreturn      The serialized records.
+ */
+static gint
+luaH_luakit_serialize(lua_State *L)
+{
+    gint n = lua_gettop(L);
+    GByteArray *out = g_byte_array_new();
+
+    for (gint i = 1; i <= n; i++) {
+        luaH_check_plain_data(L, i, 0);
+        guint offset = out->len;
+        guint32 len = 0;
+        g_byte_array_append(out, (guint8*)&len, sizeof(len));
+        lua_serialize_range(L, out, i, i);
+        len = out->len - offset - sizeof(len);
+        memcpy(out->data + offset, &len, sizeof(len));
+    }
+
+    lua_pushlstring(L, (gchar*)out->data, out->len);
+    g_byte_array_unref(out);
+    return 1;
+}
+
+/** Deserializes records produced by luakit.serialize(). Decoding stops at
+ * the first truncated or invalid record.
+ *
+ * \param  L The Lua VM state.
+ * \return   The number of elements pushed on stack (2).
+ *
+ * \luastack
+ * \lparam data  The serialized records.
+ * \lreturn      A table of the decoded values.
+ * \lreturn      The length of the valid data, in bytes.
+ */
+static gint
+luaH_luakit_deserialize(lua_State *L)
+{
+    size_t size;
+    const guint8 *data = (const guint8*)luaL_checklstring(L, 1, &size);
+    size_t pos = 0;
+    gint n = 0;
+
+    lua_newtable(L);
+    while (size - pos >= sizeof(guint32)) {
+        guint32 len;
+        memcpy(&len, data + pos, sizeof(len));
+        if (size - pos - sizeof(len) < len)
+            break;
+        const guint8 *payload = data + pos + sizeof(len);
+        if (!lua_serialized_data_validate(payload, len))
+            break;
+        gint top = lua_gettop(L);
+        if (lua_deserialize_range(L, payload, len) != 1) {
+            lua_settop(L, top);
+            break;
+        }
+        lua_rawseti(L, -2, ++n);
+        pos += sizeof(len) + len;
+    }
+    lua_pushinteger(L, pos);
+    return 2;
+}
+
 /** Executes a child synchronously (waits for the child to exit before
  * returning). The exit status and all stdout and stderr output from the
  * child is returned.
@@ -697,6 +1028,7 @@ luaH_luakit_clear_favicon_database(lua_State *UNUSED(L))
     WebKitWebContext *ctx = web_context_get();
     WebKitFaviconDatabase *fdb = webkit_web_context_get_favicon_database(ctx);
     webkit_favicon_database_clear(fdb);
+    favicon_cache_clear();
     return 0;
 }
 
@@ -861,13 +1193,17 @@ luaH_luakit_quit(lua_State *UNUSED(L))
 {
     if (gtk_main_level())
         gtk_main_quit();
-    else
+    else {
+        luakit_lib_flush_file_writes(NULL);
         exit(EXIT_SUCCESS);
+    }
     return 0;
 }
 
 /** Defined in widgets/webview.c */
 void luakit_uri_scheme_request_cb(WebKitURISchemeRequest *, gpointer);
+gint luaH_luakit_register_js(lua_State *L);
+gint luaH_luakit_unregister_js(lua_State *L);
 
 static gint
 luaH_luakit_register_scheme(lua_State *L)
@@ -941,6 +1277,11 @@ luakit_lib_setup(lua_State *L)
         { "exec",                   luaH_luakit_exec },
         { "quit",                   luaH_luakit_quit },
         { "save_file",              luaH_luakit_save_file },
+        { "save_file_async",        luaH_luakit_save_file_async },
+        { "append_file_async",      luaH_luakit_append_file_async },
+        { "serialize",              luaH_luakit_serialize },
+        { "deserialize",            luaH_luakit_deserialize },
+        { "flush_file_writes",      luaH_luakit_flush_file_writes },
         { "spawn",                  luaH_luakit_spawn },
         { "spawn_sync",             luaH_luakit_spawn_sync },
         { "register_scheme",        luaH_luakit_register_scheme },
@@ -948,6 +1289,9 @@ luakit_lib_setup(lua_State *L)
         { "wch_lower",              luaH_luakit_wch_lower },
         { "wch_upper",              luaH_luakit_wch_upper },
         { "clear_favicon_database", luaH_luakit_clear_favicon_database },
+        { "favicon_cache_stats",    luaH_favicon_cache_push_stats },
+        { "register_js",            luaH_luakit_register_js },
+        { "unregister_js",          luaH_luakit_unregister_js },
         { NULL,                     NULL }
     };
 
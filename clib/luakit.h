@@ -31,6 +31,7 @@ void luaH_register_functions_on_endpoint(ipc_endpoint_t *ipc, lua_State *L);
 lua_class_t * luakit_lib_get_luakit_class(void);
 gint luaH_class_index_miss_property(lua_State *, lua_object_t *);
 gint luaH_class_newindex_miss_property(lua_State *, lua_object_t *);
+void luakit_lib_flush_file_writes(const gchar *path);
 
 /* Referenced from deprecated webview:allow_certificate() */
 gint luaH_luakit_allow_certificate(lua_State *L);
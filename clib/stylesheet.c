@@ -37,14 +37,16 @@ luaH_stylesheet_gc(lua_State *L)
 {
     lstylesheet_t *stylesheet = luaH_checkstylesheet(L, 1);
 
-    if (stylesheet->stylesheet && globalconf.webviews) {
-        /* Need to remove stylesheet from all webviews */
-        for (unsigned i=0; i<globalconf.webviews->len; i++) {
-            widget_t *w = g_ptr_array_index(globalconf.webviews, i);
+    if (stylesheet->webviews) {
+        /* Need to remove stylesheet from all webviews it is enabled for */
+        while (stylesheet->webviews->len) {
+            widget_t *w = g_ptr_array_index(stylesheet->webviews, stylesheet->webviews->len - 1);
             webview_stylesheet_set_enabled(w, stylesheet, FALSE);
         }
-        webkit_user_style_sheet_unref(stylesheet->stylesheet);
+        g_ptr_array_free(stylesheet->webviews, TRUE);
     }
+    if (stylesheet->stylesheet)
+        webkit_user_style_sheet_unref(stylesheet->stylesheet);
     g_free (stylesheet->source);
 
     return luaH_object_gc(L);
@@ -68,10 +70,10 @@ regenerate_stylesheet(lstylesheet_t *stylesheet)
     stylesheet->stylesheet = webkit_user_style_sheet_new(stylesheet->source,
             WEBKIT_USER_CONTENT_INJECT_ALL_FRAMES, WEBKIT_USER_STYLE_LEVEL_USER, NULL, NULL);
 
-    if (old && globalconf.webviews) {
+    if (old && stylesheet->webviews) {
         /* Any web views which had this stylesheet enabled need to be regenerated */
-        for (unsigned i=0; i<globalconf.webviews->len; i++) {
-            widget_t *w = g_ptr_array_index(globalconf.webviews, i);
+        for (unsigned i=0; i<stylesheet->webviews->len; i++) {
+            widget_t *w = g_ptr_array_index(stylesheet->webviews, i);
             webview_stylesheets_regenerate_stylesheet(w, stylesheet);
         }
     }
@@ -29,6 +29,8 @@ typedef struct {
     LUA_OBJECT_HEADER
     WebKitUserStyleSheet *stylesheet;
     gchar *source;
+    /** The webviews this stylesheet is enabled for */
+    GPtrArray *webviews;
 } lstylesheet_t;
 
 void stylesheet_class_setup(lua_State *);
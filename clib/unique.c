@@ -23,6 +23,7 @@
 #include "clib/unique.h"
 #include "globalconf.h"
 #include "luah.h"
+#include "remote.h"
 
 #include <gtk/gtk.h>
 #include <glib.h>
@@ -31,6 +32,19 @@
 static lua_class_t unique_class;
 LUA_CLASS_FUNCS(unique, unique_class);
 
+/* Emit the message signal, with the screen of the active window */
+static void
+emit_message(lua_State *L)
+{
+    GtkWindow *window = gtk_application_get_active_window(globalconf.application);
+    if (!window)
+        warn("It's not a window!!!");
+    GdkScreen *screen = gtk_window_get_screen(window);
+    lua_pushlightuserdata(L, screen);
+
+    signal_object_emit(L, unique_class.signals, "message", 2, 0);
+}
+
 static void
 message_cb(GSimpleAction* UNUSED(a), GVariant *message_data, lua_State *L)
 {
@@ -38,15 +52,37 @@ message_cb(GSimpleAction* UNUSED(a), GVariant *message_data, lua_State *L)
             g_variant_is_of_type(message_data, G_VARIANT_TYPE_STRING)) {
         const gchar *text = g_variant_get_string (message_data, NULL);
         lua_pushstring(L, text);
+        emit_message(L);
+    }
+}
 
-        GtkWindow *window = gtk_application_get_active_window(globalconf.application);
-        if (!window)
-            warn("It's not a window!!!");
-        GdkScreen *screen = gtk_window_get_screen(window);
-        lua_pushlightuserdata(L, screen);
+/* URIs sent by a remote client are delivered as an open-uri-set message,
+ * exactly as if they had been sent with unique.send_message() */
+static gboolean
+remote_open_cb(gchar **uris, lua_State *L)
+{
+    lua_pushliteral(L, "open-uri-set ");
+    lua_newtable(L);
+    for (gint i = 0; uris[i]; i++) {
+        lua_pushstring(L, uris[i]);
+        lua_rawseti(L, -2, i + 1);
+    }
 
-        signal_object_emit(L, unique_class.signals, "message", 2, 0);
+    lua_pushliteral(L, "lousy.pickle");
+    lua_getglobal(L, "require");
+    if (!luaH_dofunction(L, 1, 1)) {
+        lua_pop(L, 2);
+        return FALSE;
     }
+    lua_getfield(L, -1, "pickle");
+    lua_remove(L, -2);
+    if (!luaH_dofunction(L, 1, 1)) {
+        lua_pop(L, 1);
+        return FALSE;
+    }
+    lua_concat(L, 2);
+    emit_message(L);
+    return TRUE;
 }
 
 static gboolean
@@ -101,6 +137,12 @@ luaH_unique_new(lua_State *L)
     }};
     g_action_map_add_action_entries (G_ACTION_MAP(globalconf.application),
             entries, G_N_ELEMENTS(entries), L);
+
+    /* Secondary instances of the default application send their URIs over
+     * a socket, to avoid initializing GTK and Lua */
+    if (g_str_equal(name, REMOTE_DEFAULT_APP_ID) &&
+            !g_application_get_is_remote(G_APPLICATION(globalconf.application)))
+        remote_listen(name, (remote_open_cb_t)remote_open_cb, L);
     return 0;
 }
 
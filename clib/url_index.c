@@ -0,0 +1,418 @@
+/*
+ * clib/url_index.c - in-memory URL suggestion index
+ *
+ * Copyright © 2026 luakit developers
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Entries are found through a trigram index over their match text: a query
+ * only looks at the entries containing the rarest trigram of its terms, and
+ * checks those against the full query. Queries without any term of three or
+ * more bytes scan every entry. Entries that are neither visited nor
+ * bookmarked are dead: queries skip them, and once they outnumber the live
+ * entries the index is rebuilt without them, renumbering the entry ids. The
+ * rebuild also drops the postings left behind by changed titles. */
+
+#include "clib/url_index.h"
+#include "luah.h"
+
+#include <lauxlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    gchar *uri;
+    gchar *title;
+    /** Lowercase URI and title, as matched against queries */
+    gchar *text;
+    gint visits;
+    gint64 last_visit;
+    gboolean bookmarked;
+} url_entry_t;
+
+typedef struct {
+    guint id;
+    gdouble score;
+} url_match_t;
+
+/** All entries, indexed by id */
+static GPtrArray *entries;
+/** Map from URI to entry id + 1 */
+static GHashTable *by_uri;
+/** Map from trigram to a sorted GArray of the ids of entries containing it */
+static GHashTable *trigrams;
+/** The number of live entries */
+static guint live_count;
+
+/** The number of dead entries tolerated before the index is compacted,
+ * whatever the number of live entries */
+#define URL_INDEX_COMPACT_MIN 256
+
+#define TRIGRAM(s) (((guint)(guchar)(s)[0] << 16) | ((guint)(guchar)(s)[1] << 8) | (guint)(guchar)(s)[2])
+
+static inline gboolean
+entry_is_live(const url_entry_t *e)
+{
+    return e->visits > 0 || e->bookmarked;
+}
+
+/* Update the live entry count after an entry has changed */
+static void
+entry_count_live(const url_entry_t *e, gboolean was_live)
+{
+    if (was_live && !entry_is_live(e))
+        live_count--;
+    else if (!was_live && entry_is_live(e))
+        live_count++;
+}
+
+static void
+entry_free(url_entry_t *e)
+{
+    g_free(e->uri);
+    g_free(e->title);
+    g_free(e->text);
+    g_slice_free(url_entry_t, e);
+}
+
+static gboolean
+text_has_trigram(const gchar *text, const gchar *tri)
+{
+    for (gsize len = strlen(text), i = 0; i + 3 <= len; i++)
+        if (!memcmp(text + i, tri, 3))
+            return TRUE;
+    return FALSE;
+}
+
+/* Add an id to a sorted array of ids, unless it is already present; postings
+ * are never removed, so an entry whose title changes back and forth would
+ * otherwise be listed more than once */
+static void
+postings_add(GArray *ids, guint id)
+{
+    guint lo = 0, hi = ids->len;
+    if (hi && g_array_index(ids, guint, hi - 1) < id)
+        lo = hi;
+    while (lo < hi) {
+        guint mid = lo + (hi - lo) / 2;
+        guint other = g_array_index(ids, guint, mid);
+        if (other == id)
+            return;
+        if (other < id)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    g_array_insert_val(ids, lo, id);
+}
+
+/* Add an entry to the postings of the trigrams in its new match text */
+static void
+index_text(guint id, const gchar *old_text, const gchar *text)
+{
+    for (gsize len = strlen(text), i = 0; i + 3 <= len; i++) {
+        if (old_text && text_has_trigram(old_text, text + i))
+            continue;
+        gpointer key = GUINT_TO_POINTER(TRIGRAM(text + i));
+        GArray *ids = g_hash_table_lookup(trigrams, key);
+        if (!ids) {
+            ids = g_array_sized_new(FALSE, FALSE, sizeof(guint), 4);
+            g_hash_table_insert(trigrams, key, ids);
+        }
+        postings_add(ids, id);
+    }
+}
+
+static void
+entry_set_title(guint id, url_entry_t *e, const gchar *title)
+{
+    if (e->title && !g_strcmp0(e->title, title))
+        return;
+    g_free(e->title);
+    e->title = g_strdup(title ? title : "");
+
+    gchar *text = g_strconcat(e->uri, e->title, NULL);
+    gchar *lower = g_ascii_strdown(text, -1);
+    g_free(text);
+    index_text(id, e->text, lower);
+    g_free(e->text);
+    e->text = lower;
+}
+
+static url_entry_t *
+entry_get(const gchar *uri, gboolean create, guint *id)
+{
+    guint n = GPOINTER_TO_UINT(g_hash_table_lookup(by_uri, uri));
+    if (n) {
+        *id = n - 1;
+        return g_ptr_array_index(entries, n - 1);
+    }
+    if (!create)
+        return NULL;
+
+    url_entry_t *e = g_slice_new0(url_entry_t);
+    e->uri = g_strdup(uri);
+    *id = entries->len;
+    g_ptr_array_add(entries, e);
+    g_hash_table_insert(by_uri, e->uri, GUINT_TO_POINTER(*id + 1));
+    entry_set_title(*id, e, NULL);
+    return e;
+}
+
+/* Rebuild the index from the live entries, freeing the dead ones */
+static void
+url_index_compact(void)
+{
+    GPtrArray *old = entries;
+    entries = g_ptr_array_sized_new(live_count);
+    g_hash_table_remove_all(by_uri);
+    g_hash_table_remove_all(trigrams);
+
+    for (guint i = 0; i < old->len; i++) {
+        url_entry_t *e = g_ptr_array_index(old, i);
+        if (!entry_is_live(e)) {
+            entry_free(e);
+            continue;
+        }
+        guint id = entries->len;
+        g_ptr_array_add(entries, e);
+        g_hash_table_insert(by_uri, e->uri, GUINT_TO_POINTER(id + 1));
+        index_text(id, NULL, e->text);
+    }
+    g_ptr_array_free(old, TRUE);
+}
+
+static void
+url_index_maybe_compact(void)
+{
+    guint dead = entries->len - live_count;
+    if (dead > MAX(live_count, URL_INDEX_COMPACT_MIN))
+        url_index_compact();
+}
+
+/* Frecency: visits weighted by how recently the entry was visited, with a
+ * bonus for bookmarks */
+static gdouble
+entry_score(const url_entry_t *e, gint64 now)
+{
+    gint64 days = (now - e->last_visit) / 86400;
+    gdouble weight = days < 4 ? 100 : days < 14 ? 70 : days < 31 ? 50 : days < 90 ? 30 : 10;
+    return (e->visits + (e->bookmarked ? 5 : 0)) * weight;
+}
+
+/* Whether all terms occur in the text, in order, without overlapping; this
+ * is the match done by the `%term%term%` LIKE patterns of history
+ * completion */
+static gboolean
+entry_matches(const url_entry_t *e, gchar **terms)
+{
+    const gchar *pos = e->text;
+    for (gchar **t = terms; *t; t++) {
+        if (!(pos = strstr(pos, *t)))
+            return FALSE;
+        pos += strlen(*t);
+    }
+    return TRUE;
+}
+
+/* Keep the best `limit` matches, sorted by score then last visit time */
+static void
+matches_insert(GArray *matches, guint limit, guint id, gdouble score)
+{
+    const url_entry_t *e = g_ptr_array_index(entries, id);
+    guint i = matches->len;
+    while (i > 0) {
+        url_match_t *m = &g_array_index(matches, url_match_t, i - 1);
+        const url_entry_t *other = g_ptr_array_index(entries, m->id);
+        if (m->score > score || (m->score == score && other->last_visit >= e->last_visit))
+            break;
+        i--;
+    }
+    if (i >= limit)
+        return;
+    url_match_t m = { .id = id, .score = score };
+    g_array_insert_val(matches, i, m);
+    if (matches->len > limit)
+        g_array_set_size(matches, limit);
+}
+
+static gint
+luaH_url_index_add(lua_State *L)
+{
+    const gchar *uri = luaL_checkstring(L, 1);
+    const gchar *title = luaL_optstring(L, 2, NULL);
+    gint visits = luaL_optint(L, 3, 1);
+    gint64 last_visit = luaL_optnumber(L, 4, time(NULL));
+
+    guint id;
+    url_entry_t *e = entry_get(uri, TRUE, &id);
+    gboolean was_live = entry_is_live(e);
+    e->visits += visits;
+    e->last_visit = MAX(e->last_visit, last_visit);
+    entry_count_live(e, was_live);
+    if (title)
+        entry_set_title(id, e, title);
+    return 0;
+}
+
+static gint
+luaH_url_index_bookmark(lua_State *L)
+{
+    const gchar *uri = luaL_checkstring(L, 1);
+    gboolean bookmarked = lua_isnone(L, 2) || lua_toboolean(L, 2);
+    const gchar *title = luaL_optstring(L, 3, NULL);
+
+    guint id;
+    url_entry_t *e = entry_get(uri, bookmarked, &id);
+    if (!e)
+        return 0;
+    gboolean was_live = entry_is_live(e);
+    e->bookmarked = bookmarked;
+    entry_count_live(e, was_live);
+    /* Only bookmarks that were never visited take their title */
+    if (title && *title && !*e->title)
+        entry_set_title(id, e, title);
+    url_index_maybe_compact();
+    return 0;
+}
+
+static gint
+luaH_url_index_remove(lua_State *L)
+{
+    const gchar *uri = luaL_checkstring(L, 1);
+    guint id;
+    url_entry_t *e = entry_get(uri, FALSE, &id);
+    if (e) {
+        gboolean was_live = entry_is_live(e);
+        e->visits = 0;
+        e->last_visit = 0;
+        entry_count_live(e, was_live);
+        url_index_maybe_compact();
+    }
+    return 0;
+}
+
+static gint
+luaH_url_index_clear(lua_State *UNUSED(L))
+{
+    live_count = 0;
+    for (guint i = 0; i < entries->len; i++) {
+        url_entry_t *e = g_ptr_array_index(entries, i);
+        e->visits = 0;
+        e->last_visit = 0;
+        live_count += entry_is_live(e);
+    }
+    url_index_compact();
+    return 0;
+}
+
+static gint
+luaH_url_index_size(lua_State *L)
+{
+    lua_pushinteger(L, live_count);
+    return 1;
+}
+
+static gint
+luaH_url_index_query(lua_State *L)
+{
+    gchar *lower = g_ascii_strdown(luaL_checkstring(L, 1), -1);
+    guint limit = MAX(luaL_optint(L, 2, 25), 0);
+    gchar **terms = g_strsplit_set(g_strstrip(lower), " \t\n\r\f\v", -1);
+    g_free(lower);
+
+    /* Drop empty terms left by runs of whitespace */
+    guint n = 0;
+    for (gchar **t = terms; *t; t++) {
+        if (**t)
+            terms[n++] = *t;
+        else
+            g_free(*t);
+    }
+    terms[n] = NULL;
+
+    /* Find the trigram shared by the fewest entries */
+    GArray *candidates = NULL;
+    gboolean none = FALSE;
+    for (gchar **t = terms; *t && !none; t++) {
+        for (gsize len = strlen(*t), i = 0; i + 3 <= len; i++) {
+            GArray *ids = g_hash_table_lookup(trigrams, GUINT_TO_POINTER(TRIGRAM(*t + i)));
+            if (!ids) {
+                none = TRUE;
+                break;
+            }
+            if (!candidates || ids->len < candidates->len)
+                candidates = ids;
+        }
+    }
+
+    GArray *matches = g_array_sized_new(FALSE, FALSE, sizeof(url_match_t), limit + 1);
+    gint64 now = time(NULL);
+    guint count = none ? 0 : candidates ? candidates->len : entries->len;
+    for (guint i = 0; i < count && limit; i++) {
+        guint id = candidates ? g_array_index(candidates, guint, i) : i;
+        const url_entry_t *e = g_ptr_array_index(entries, id);
+        if (entry_is_live(e) && entry_matches(e, terms))
+            matches_insert(matches, limit, id, entry_score(e, now));
+    }
+    g_strfreev(terms);
+
+    lua_createtable(L, matches->len, 0);
+    for (guint i = 0; i < matches->len; i++) {
+        url_match_t *m = &g_array_index(matches, url_match_t, i);
+        const url_entry_t *e = g_ptr_array_index(entries, m->id);
+        lua_createtable(L, 0, 6);
+        lua_pushstring(L, e->uri);
+        lua_setfield(L, -2, "uri");
+        lua_pushstring(L, e->title);
+        lua_setfield(L, -2, "title");
+        lua_pushstring(L, e->text);
+        lua_setfield(L, -2, "text");
+        lua_pushinteger(L, e->visits);
+        lua_setfield(L, -2, "visits");
+        lua_pushnumber(L, e->last_visit);
+        lua_setfield(L, -2, "last_visit");
+        lua_pushnumber(L, m->score);
+        lua_setfield(L, -2, "score");
+        lua_rawseti(L, -2, i + 1);
+    }
+    g_array_free(matches, TRUE);
+    return 1;
+}
+
+void
+url_index_lib_setup(lua_State *L)
+{
+    static const struct luaL_Reg url_index_lib[] =
+    {
+        { "add", luaH_url_index_add },
+        { "bookmark", luaH_url_index_bookmark },
+        { "remove", luaH_url_index_remove },
+        { "clear", luaH_url_index_clear },
+        { "size", luaH_url_index_size },
+        { "query", luaH_url_index_query },
+        { NULL, NULL }
+    };
+
+    entries = g_ptr_array_new();
+    by_uri = g_hash_table_new(g_str_hash, g_str_equal);
+    trigrams = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+            NULL, (GDestroyNotify)g_array_unref);
+
+    luaH_openlib(L, "url_index", url_index_lib, url_index_lib);
+}
+
+// vim: ft=c:et:sw=4:ts=8:sts=4:tw=80
@@ -156,8 +156,10 @@ luaH_widget_index(lua_State *L)
     gint ret;
     widget_t *widget = luaH_checkwidget(L, 1);
 
-    /* but only if it's not a GtkWidget property */
-    if ((ret = luaH_gobject_index(L, widget_properties, token,
+    /* but only if it's not a GtkWidget property; webviews are packed into
+     * an unfocusable container, and handle can_focus themselves */
+    if ((widget->info->tok != L_TK_WEBVIEW || token != L_TK_CAN_FOCUS) &&
+            (ret = luaH_gobject_index(L, widget_properties, token,
                     G_OBJECT(widget->widget)))) {
         return ret;
     }
@@ -189,7 +191,8 @@ luaH_widget_newindex(lua_State *L)
 #endif
 
     /* but only if it's not a GtkWidget property */
-    gboolean emit = luaH_gobject_newindex(L, widget_properties, token, 3,
+    gboolean emit = (widget->info->tok != L_TK_WEBVIEW || token != L_TK_CAN_FOCUS) &&
+        luaH_gobject_newindex(L, widget_properties, token, 3,
             G_OBJECT(widget->widget));
     if (emit)
         return luaH_object_property_signal(L, 1, token);
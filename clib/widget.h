@@ -83,6 +83,10 @@ struct widget_t
 #endif
     /* Previous width and height, for resize signal */
     gint prev_width, prev_height;
+    /* Key binds handled without emitting key-press, see key_press_cb() */
+    GHashTable *native_binds;
+    /* Whether native binds also match synthetic key events */
+    gboolean native_binds_synthetic;
     /* Misc private data */
     gpointer data;
 };
@@ -3,6 +3,7 @@
  *
  * Copyright © 2010 Fabian Streitel <karottenreibe@gmail.com>
  * Copyright © 2010 Mason Larobina <mason.larobina@gmail.com>
+ * Copyright © 2026 luakit developers
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -25,49 +26,133 @@
 
 #include <glib.h>
 
+/* All running timers share a single main loop source. Each timer may fire
+ * up to its slack after its deadline; the source wakes up at the earliest
+ * such limit, and fires every timer that is due by then, so timers with
+ * similar deadlines are run in one wakeup. When the limit is at least a
+ * second past the next deadline, the source is a g_timeout_add_seconds()
+ * source, which GLib aligns with the whole-second timeouts of other
+ * sources. */
+
 typedef struct {
     LUA_OBJECT_HEADER
     gpointer ref;
-    int id;
+    gboolean started;
     int interval;
+    /** How long the timer may fire after its deadline, in milliseconds */
+    int slack;
+    /** When the timer is next due, in microseconds of monotonic time */
+    gint64 deadline;
+    /** Number of times the timer has fired */
+    guint64 fire_count;
+    /** Total time spent in timeout signal handlers, in microseconds */
+    gint64 callback_time;
 } ltimer_t;
 
 static lua_class_t timer_class;
 LUA_OBJECT_FUNCS(timer_class, ltimer_t, timer)
 
-#define TIMER_STOPPED -1
-
 #define luaH_checktimer(L, idx) luaH_checkudata(L, idx, &(timer_class))
 
+/** All started timers */
+static GPtrArray *timers;
+/** The shared wakeup source, if any timers are started */
+static guint wakeup_id;
+/** Whether timers are being fired; the wakeup is rescheduled afterwards */
+static gboolean firing;
+
+static gboolean timer_wakeup(gpointer data);
+
+static inline gint64
+timer_next_deadline(ltimer_t *timer)
+{
+    return g_get_monotonic_time() + (gint64)MAX(timer->interval, 1) * 1000;
+}
+
 static void
-luaH_timer_destroy(lua_State *L, ltimer_t *timer) {
-    GSource *source = g_main_context_find_source_by_id(NULL, timer->id);
-    if (source != NULL)
-        g_source_destroy(source);
+timer_schedule_wakeup(void)
+{
+    if (firing)
+        return;
+    if (wakeup_id) {
+        g_source_remove(wakeup_id);
+        wakeup_id = 0;
+    }
+    if (!timers || !timers->len)
+        return;
 
-    /* allow timer to be garbage collected */
-    luaH_object_unref(L, timer->ref);
-    timer->ref = NULL;
+    gint64 first = G_MAXINT64, limit = G_MAXINT64;
+    for (guint i = 0; i < timers->len; i++) {
+        ltimer_t *timer = g_ptr_array_index(timers, i);
+        first = MIN(first, timer->deadline);
+        limit = MIN(limit, timer->deadline + (gint64)timer->slack * 1000);
+    }
 
-    timer->id = TIMER_STOPPED;
+    gint64 now = g_get_monotonic_time();
+    gint64 secs = (first - now + G_USEC_PER_SEC - 1) / G_USEC_PER_SEC;
+    if (secs > 0 && limit - now >= (secs + 1) * G_USEC_PER_SEC)
+        wakeup_id = g_timeout_add_seconds(secs, timer_wakeup, NULL);
+    else
+        wakeup_id = g_timeout_add(MAX(limit - now + 999, 0) / 1000, timer_wakeup, NULL);
 }
 
-static gboolean
-timer_handle_timeout(gpointer data)
+static void
+timer_fire(ltimer_t *timer)
 {
-    ltimer_t *timer = (ltimer_t *) data;
+    /* Reschedule first, so that the handler can stop or restart it */
+    timer->deadline = timer_next_deadline(timer);
+    timer->fire_count++;
+
+    gint64 start = g_get_monotonic_time();
     luaH_object_push(common.L, timer->ref);
     luaH_object_emit_signal(common.L, -1, "timeout", 0, 0);
+    timer->callback_time += g_get_monotonic_time() - start;
     lua_pop(common.L, 1);
-    return TRUE;
+}
+
+static gboolean
+timer_wakeup(gpointer UNUSED(data))
+{
+    wakeup_id = 0;
+    firing = TRUE;
+
+    /* Handlers may start and stop any timer, so look for the next due timer
+     * again after each one; a fired timer isn't due again until after now */
+    gint64 now = g_get_monotonic_time();
+    gboolean fired;
+    do {
+        fired = FALSE;
+        for (guint i = 0; i < timers->len; i++) {
+            ltimer_t *timer = g_ptr_array_index(timers, i);
+            if (timer->deadline <= now) {
+                timer_fire(timer);
+                fired = TRUE;
+                break;
+            }
+        }
+    } while (fired);
+
+    firing = FALSE;
+    timer_schedule_wakeup();
+    return FALSE;
+}
+
+static void
+luaH_timer_destroy(lua_State *L, ltimer_t *timer) {
+    g_ptr_array_remove_fast(timers, timer);
+    timer->started = FALSE;
+
+    /* allow timer to be garbage collected */
+    luaH_object_unref(L, timer->ref);
+    timer->ref = NULL;
+
+    timer_schedule_wakeup();
 }
 
 static int
 luaH_timer_new(lua_State *L)
 {
     luaH_class_new(L, &timer_class);
-    ltimer_t *timer = luaH_checktimer(L, -1);
-    timer->id = TIMER_STOPPED;
     return 1;
 }
 
@@ -78,10 +163,15 @@ luaH_timer_start(lua_State *L)
     if (!timer->interval)
         luaL_error(L, "interval not set");
 
-    if (timer->id == TIMER_STOPPED) {
+    if (!timer->started) {
         /* ensure timer isn't collected while running */
         timer->ref = luaH_object_ref(L, 1);
-        timer->id = g_timeout_add(timer->interval, timer_handle_timeout, timer);
+        timer->started = TRUE;
+        timer->deadline = timer_next_deadline(timer);
+        if (!timers)
+            timers = g_ptr_array_new();
+        g_ptr_array_add(timers, timer);
+        timer_schedule_wakeup();
     } else
         luaH_warn(L, "timer already started");
     return 0;
@@ -91,7 +181,7 @@ static int
 luaH_timer_stop(lua_State *L)
 {
     ltimer_t *timer = luaH_checktimer(L, 1);
-    if (timer->id == TIMER_STOPPED)
+    if (!timer->started)
         luaH_warn(L, "timer already stopped");
     else
         luaH_timer_destroy(L, timer);
@@ -115,7 +205,40 @@ luaH_timer_get_interval(lua_State *L, ltimer_t *timer)
 static int
 luaH_timer_get_started(lua_State *L, ltimer_t *timer)
 {
-    lua_pushboolean(L, (timer->id != TIMER_STOPPED));
+    lua_pushboolean(L, timer->started);
+    return 1;
+}
+
+static int
+luaH_timer_set_slack(lua_State *L, ltimer_t *timer)
+{
+    gint slack = luaL_checkint(L, -1);
+    if (slack < 0)
+        return luaL_error(L, "slack must not be negative");
+    timer->slack = slack;
+    if (timer->started)
+        timer_schedule_wakeup();
+    return 0;
+}
+
+static int
+luaH_timer_get_slack(lua_State *L, ltimer_t *timer)
+{
+    lua_pushinteger(L, timer->slack);
+    return 1;
+}
+
+static int
+luaH_timer_get_fire_count(lua_State *L, ltimer_t *timer)
+{
+    lua_pushnumber(L, timer->fire_count);
+    return 1;
+}
+
+static int
+luaH_timer_get_callback_time(lua_State *L, ltimer_t *timer)
+{
+    lua_pushnumber(L, timer->callback_time / 1e6);
     return 1;
 }
 
@@ -165,6 +288,21 @@ timer_class_setup(lua_State *L)
             NULL,
             (lua_class_propfunc_t) luaH_timer_get_started,
             NULL);
+
+    luaH_class_add_property(&timer_class, L_TK_SLACK,
+            (lua_class_propfunc_t) luaH_timer_set_slack,
+            (lua_class_propfunc_t) luaH_timer_get_slack,
+            (lua_class_propfunc_t) luaH_timer_set_slack);
+
+    luaH_class_add_property(&timer_class, L_TK_FIRE_COUNT,
+            NULL,
+            (lua_class_propfunc_t) luaH_timer_get_fire_count,
+            NULL);
+
+    luaH_class_add_property(&timer_class, L_TK_CALLBACK_TIME,
+            NULL,
+            (lua_class_propfunc_t) luaH_timer_get_callback_time,
+            NULL);
 }
 
 #undef luaH_checktimer
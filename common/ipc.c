@@ -39,6 +39,9 @@ static GThread *send_thread;
 static GAsyncQueue *send_queue;
 /** IPC endpoints for all webviews */
 static GPtrArray *endpoints;
+/** Sends the messages batched by a sender before any other message */
+static void (*flush_func)(ipc_endpoint_t *ipc, gpointer sender);
+static gboolean flushing;
 
 typedef struct _queued_ipc_t {
     ipc_header_t header;
@@ -96,9 +99,45 @@ ipc_send_thread(gpointer UNUSED(user_data))
     return NULL;
 }
 
+void
+ipc_set_flush_func(void (*func)(ipc_endpoint_t *ipc, gpointer sender))
+{
+    flush_func = func;
+}
+
+/** Record that a sender has messages batched for an endpoint, to be passed
+ * to the flush function before any other message is sent to it. */
+void
+ipc_endpoint_add_batched(ipc_endpoint_t *ipc, gpointer sender)
+{
+    if (!ipc->batched)
+        ipc->batched = g_ptr_array_sized_new(1);
+    g_ptr_array_add(ipc->batched, sender);
+}
+
+/** Forget a sender added with ipc_endpoint_add_batched(), once it has sent
+ * or dropped its batched messages. */
+void
+ipc_endpoint_remove_batched(ipc_endpoint_t *ipc, gpointer sender)
+{
+    if (ipc->batched)
+        g_ptr_array_remove_fast(ipc->batched, sender);
+}
+
 void
 ipc_send(ipc_endpoint_t *ipc, const ipc_header_t *header, const void *data)
 {
+    /* Keep batched messages in order with this one */
+    if (ipc->batched && ipc->batched->len && flush_func && !flushing) {
+        GPtrArray *batched = ipc->batched;
+        ipc->batched = NULL;
+        flushing = TRUE;
+        for (guint i = 0; i < batched->len; i++)
+            flush_func(ipc, g_ptr_array_index(batched, i));
+        flushing = FALSE;
+        g_ptr_array_free(batched, TRUE);
+    }
+
     if (!send_thread) {
         send_queue = g_async_queue_new();
         send_thread = g_thread_new("send_thread", ipc_send_thread, NULL);
@@ -274,6 +313,8 @@ ipc_endpoint_decref(ipc_endpoint_t *ipc)
         }
         g_queue_free(ipc->queue);
     }
+    if (ipc->batched)
+        g_ptr_array_free(ipc->batched, TRUE);
     ipc->status = IPC_ENDPOINT_FREED;
     g_slice_free(ipc_endpoint_t, ipc);
 }
@@ -305,7 +346,8 @@ ipc_endpoint_connect_to_socket(ipc_endpoint_t *ipc, int sock)
         endpoints = g_ptr_array_sized_new(1);
 
     /* Add the endpoint; it should never be present already */
-    g_assert(!g_ptr_array_remove_fast(endpoints, ipc));
+    g_assert(ipc->index >= endpoints->len || g_ptr_array_index(endpoints, ipc->index) != ipc);
+    ipc->index = endpoints->len;
     g_ptr_array_add(endpoints, ipc);
 }
 
@@ -334,6 +376,14 @@ ipc_endpoint_replace(ipc_endpoint_t *orig, ipc_endpoint_t *new)
         orig->queue = NULL;
     }
 
+    /* Batched messages now go to the new endpoint */
+    if (orig->batched) {
+        for (guint i = 0; i < orig->batched->len; i++)
+            ipc_endpoint_add_batched(new, g_ptr_array_index(orig->batched, i));
+        g_ptr_array_free(orig->batched, TRUE);
+        orig->batched = NULL;
+    }
+
     ipc_endpoint_decref(orig);
     return new;
 }
@@ -344,7 +394,13 @@ ipc_endpoint_disconnect(ipc_endpoint_t *ipc)
     g_assert(ipc->status == IPC_ENDPOINT_CONNECTED);
     g_assert(ipc->channel);
 
-    g_ptr_array_remove_fast(endpoints, ipc);
+    /* Move the last endpoint into this one's place */
+    g_assert(g_ptr_array_index(endpoints, ipc->index) == ipc);
+    g_ptr_array_remove_index_fast(endpoints, ipc->index);
+    if (ipc->index < endpoints->len) {
+        ipc_endpoint_t *moved = g_ptr_array_index(endpoints, ipc->index);
+        moved->index = ipc->index;
+    }
 
     /* Remove watches */
     ipc_recv_state_t *state = &ipc->recv_state;
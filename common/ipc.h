@@ -31,6 +31,8 @@
     X(log) \
     X(page_created) \
     X(crash) \
+    X(js_register) \
+    X(trace) \
 
 #define X(name) IPC_TYPE_EXPONENT_##name,
 typedef enum { IPC_TYPES } _ipc_type_exponent_t;
@@ -122,6 +124,11 @@ typedef struct _ipc_endpoint_t {
     gint refcount;
     /** Whether the endpoint creation signal has been emitted */
     gboolean creation_notified;
+    /** Position in the list of connected endpoints */
+    guint index;
+    /** Senders with messages batched for this endpoint, which are flushed
+     * before any other message is sent to it; NULL if there are none */
+    GPtrArray *batched;
 } ipc_endpoint_t;
 
 ipc_endpoint_t *ipc_endpoint_new(const gchar *name);
@@ -136,6 +143,9 @@ const GPtrArray *ipc_endpoints_get(void);
 
 void ipc_send_lua(ipc_endpoint_t *ipc, ipc_type_t type, lua_State *L, gint start, gint end);
 void ipc_send(ipc_endpoint_t *ipc, const ipc_header_t *header, const void *data);
+void ipc_set_flush_func(void (*func)(ipc_endpoint_t *ipc, gpointer sender));
+void ipc_endpoint_add_batched(ipc_endpoint_t *ipc, gpointer sender);
+void ipc_endpoint_remove_batched(ipc_endpoint_t *ipc, gpointer sender);
 
 #define IPC_NO_HANDLER(type) \
 void \
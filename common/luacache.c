@@ -0,0 +1,221 @@
+/*
+ * common/luacache.c - Lua bytecode cache
+ *
+ * Copyright © 2026 luakit developers
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/luacache.h"
+#include "common/log.h"
+#include "common/util.h"
+
+#include <lauxlib.h>
+#include <glib/gstdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Directory holding cached bytecode; NULL if the cache is disabled */
+static gchar *bytecode_dir;
+/* Identifies the Lua build, since bytecode is not portable between builds */
+static gchar *lua_build;
+
+static int
+bytecode_writer(lua_State *UNUSED(L), const void *p, size_t sz, void *ud)
+{
+    g_byte_array_append(ud, p, sz);
+    return 0;
+}
+
+/** Load a Lua source file as a function, like luaL_loadfile(), using
+ * cached bytecode if the file has not changed since it was last compiled.
+ *
+ * Cache files are named after a hash of the absolute path of the source
+ * file, and begin with a header recording the Lua build, path and a hash of
+ * the contents of the source; any mismatch, or bytecode that fails to load, falls
+ * back to compiling the source file and replacing the cache file.
+ *
+ * \param L    The Lua VM state.
+ * \param path The path of the Lua source file.
+ * \return     0 on success, with the function pushed onto the stack;
+ *             otherwise an error code, with the error message pushed.
+ */
+gint
+luaH_loadfile(lua_State *L, const gchar *path)
+{
+    gchar *source;
+    gsize source_len;
+    if (!bytecode_dir || !g_file_get_contents(path, &source, &source_len, NULL))
+        return luaL_loadfile(L, path);
+
+    gchar *abspath;
+    if (g_path_is_absolute(path))
+        abspath = g_strdup(path);
+    else {
+        gchar *cwd = g_get_current_dir();
+        abspath = g_build_filename(cwd, path, NULL);
+        g_free(cwd);
+    }
+
+    /* Hashing the source catches changes that keep the mtime and size, such
+     * as two saves within the same second */
+    gchar *source_hash = g_compute_checksum_for_data(G_CHECKSUM_SHA1, (guchar*)source, source_len);
+    gchar *header = g_strdup_printf("luakit bytecode\n%s\n%s\n%s\n",
+            lua_build, abspath, source_hash);
+    g_free(source_hash);
+    gsize header_len = strlen(header);
+    gchar *hash = g_compute_checksum_for_string(G_CHECKSUM_SHA1, abspath, -1);
+    gchar *cache_path = g_build_filename(bytecode_dir, hash, NULL);
+    g_free(hash);
+    g_free(abspath);
+
+    gint ret;
+    gchar *contents;
+    gsize len;
+    gchar *chunkname = g_strconcat("@", path, NULL);
+    if (g_file_get_contents(cache_path, &contents, &len, NULL)) {
+        if (len > header_len && !memcmp(contents, header, header_len)) {
+            ret = luaL_loadbuffer(L, contents + header_len, len - header_len, chunkname);
+            if (!ret) {
+                g_free(contents);
+                goto done;
+            }
+            verbose("ignoring cached bytecode for '%s': %s", path, lua_tostring(L, -1));
+            lua_pop(L, 1);
+        }
+        g_free(contents);
+    }
+
+    /* Compile the source that was hashed, rather than reading the file again,
+     * so that the cached bytecode always matches its header. Like
+     * luaL_loadfile(), skip a first line starting with '#', but keep its
+     * newline so that line numbers are unchanged. */
+    const gchar *code = source;
+    if (source_len && source[0] == '#')
+        code = memchr(source, '\n', source_len) ?: source + source_len;
+
+    /* Compile the source file, and cache its bytecode for next time */
+    if (!(ret = luaL_loadbuffer(L, code, source + source_len - code, chunkname))) {
+        GByteArray *buf = g_byte_array_new();
+        g_byte_array_append(buf, (guint8*)header, header_len);
+        GError *err = NULL;
+        if (lua_dump(L, bytecode_writer, buf))
+            verbose("unable to dump bytecode for '%s'", path);
+        else if (!g_file_set_contents(cache_path, (gchar*)buf->data, buf->len, &err)) {
+            verbose("unable to cache bytecode for '%s': %s", path, err->message);
+            g_error_free(err);
+        }
+        g_byte_array_free(buf, TRUE);
+    }
+
+done:
+    g_free(chunkname);
+    g_free(source);
+    g_free(cache_path);
+    g_free(header);
+    return ret;
+}
+
+/* Replacement for the standard Lua file searcher in package.loaders */
+static gint
+luaH_bytecode_searcher(lua_State *L)
+{
+    const gchar *name = luaL_checkstring(L, 1);
+    lua_getglobal(L, "package");
+    lua_getfield(L, -1, "path");
+    const gchar *templates = lua_tostring(L, -1);
+    if (!templates)
+        return luaL_error(L, "'package.path' must be a string");
+
+    gchar *filename = g_strdelimit(g_strdup(name), ".", '/');
+    gchar **templ = g_strsplit(templates, ";", -1);
+    GString *tried = g_string_new(NULL);
+    gchar *path = NULL;
+
+    for (gchar **t = templ; *t; t++) {
+        if (!**t)
+            continue;
+        gchar **parts = g_strsplit(*t, "?", -1);
+        path = g_strjoinv(filename, parts);
+        g_strfreev(parts);
+        if (!g_access(path, R_OK))
+            break;
+        g_string_append_printf(tried, "\n\tno file '%s'", path);
+        g_free(path);
+        path = NULL;
+    }
+
+    g_strfreev(templ);
+    g_free(filename);
+
+    if (!path) {
+        lua_pushstring(L, tried->str);
+        g_string_free(tried, TRUE);
+        return 1;
+    }
+    g_string_free(tried, TRUE);
+
+    if (luaH_loadfile(L, path)) {
+        lua_pushfstring(L, "error loading module '%s' from file '%s':\n\t%s",
+                name, path, lua_tostring(L, -1));
+        g_free(path);
+        return lua_error(L);
+    }
+
+    g_free(path);
+    return 1;
+}
+
+/** Enable the bytecode cache, and use it for modules loaded with require().
+ *
+ * Each process type must use its own cache directory: web processes run
+ * untrusted page content, so bytecode they write must never be loaded by
+ * the UI process.
+ *
+ * \param L         The Lua VM state.
+ * \param cache_dir The directory in which to create the cache.
+ * \param name      The name of the cache directory within \p cache_dir.
+ */
+void
+luaH_bytecode_cache_setup(lua_State *L, const gchar *cache_dir, const gchar *name)
+{
+    gchar *dir = g_build_filename(cache_dir, name, NULL);
+    if (g_mkdir_with_parents(dir, 0700)) {
+        warn("unable to create bytecode cache directory '%s'", dir);
+        g_free(dir);
+        return;
+    }
+    g_free(bytecode_dir);
+    bytecode_dir = dir;
+
+    /* jit.version for LuaJIT, _VERSION otherwise */
+    lua_getglobal(L, "jit");
+    if (lua_istable(L, -1))
+        lua_getfield(L, -1, "version");
+    else
+        lua_getglobal(L, "_VERSION");
+    g_free(lua_build);
+    lua_build = g_strdup_printf("%s %u", lua_tostring(L, -1), (guint)sizeof(void*));
+    lua_pop(L, 2);
+
+    /* Replace the Lua file searcher; the preload searcher runs before it */
+    lua_getglobal(L, "package");
+    lua_getfield(L, -1, "loaders");
+    lua_pushcfunction(L, luaH_bytecode_searcher);
+    lua_rawseti(L, -2, 2);
+    lua_pop(L, 2);
+}
+
+// vim: ft=c:et:sw=4:ts=8:sts=4:tw=80
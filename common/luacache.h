@@ -0,0 +1,32 @@
+/*
+ * common/luacache.h - Lua bytecode cache
+ *
+ * Copyright © 2026 luakit developers
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LUAKIT_COMMON_LUACACHE_H
+#define LUAKIT_COMMON_LUACACHE_H
+
+#include <lua.h>
+#include <glib.h>
+
+void luaH_bytecode_cache_setup(lua_State *L, const gchar *cache_dir, const gchar *name);
+gint luaH_loadfile(lua_State *L, const gchar *path);
+
+#endif /* end of include guard: LUAKIT_COMMON_LUACACHE_H */
+
+// vim: ft=c:et:sw=4:ts=8:sts=4:tw=80
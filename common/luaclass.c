@@ -22,6 +22,7 @@
 #include "common/luaclass.h"
 #include "common/luaobject.h"
 #include "common/luayield.h"
+#include "common/trace.h"
 
 #include <stdlib.h>
 
@@ -272,7 +273,16 @@ luaH_class_remove_signal(lua_State *L, lua_class_t *lua_class,
 gint
 luaH_class_emit_signal(lua_State *L, lua_class_t *lua_class,
         const gchar *name, gint nargs, gint nret) {
-    return signal_object_emit(L, lua_class->signals, name, nargs, nret);
+    /* Only trace signals that have handlers */
+    if (!trace_enabled || !signal_lookup(lua_class->signals, name))
+        return signal_object_emit(L, lua_class->signals, name, nargs, nret);
+
+    gchar *signame = g_strdup_printf("%s::%s", lua_class->name, name);
+    gint64 start = trace_now();
+    gint ret = signal_object_emit(L, lua_class->signals, name, nargs, nret);
+    trace_span("signal", signame, start);
+    g_free(signame);
+    return ret;
 }
 
 gint
@@ -280,7 +290,7 @@ luaH_class_property_signal(lua_State *L, lua_class_t *lua_class,
         luakit_token_t tok)
 {
     gchar *signame = g_strdup_printf("property::%s", token_tostring(tok));
-    signal_object_emit(L, lua_class->signals, signame, 0, 0);
+    luaH_class_emit_signal(L, lua_class, signame, 0, 0);
     g_free(signame);
     return 0;
 }
@@ -46,59 +46,229 @@ luaJS_pushstring(lua_State *L, JSContextRef context, JSValueRef value, gchar **e
     return 0;
 }
 
-gint
-luaJS_pushobject(lua_State *L, JSContextRef context, JSObjectRef obj, gchar **error)
+/* Maximum nesting depth of JavaScript objects converted into Lua tables */
+#define LUAJS_MAX_DEPTH 64
+
+/* State shared by a single (recursive) JS->Lua value conversion */
+typedef struct _luajs_convert_t {
+    JSObjectRef path[LUAJS_MAX_DEPTH];
+    guint depth;
+} luajs_convert_t;
+
+static gint luaJS_pushvalue_r(lua_State *L, JSContextRef context, JSValueRef value, luajs_convert_t *conv, gchar **error);
+
+/* Scratch buffer for property names; only used between fetching a key and
+ * pushing it onto the Lua stack, so it is safe to share across recursion */
+static gchar *key_buf;
+static size_t key_buf_size;
+
+static const gchar *
+key_to_utf8(JSStringRef key, size_t *len)
 {
-    gint top = lua_gettop(L);
+    size_t size = JSStringGetMaximumUTF8CStringSize(key);
+    if (size > key_buf_size) {
+        key_buf_size = MAX(size, 64);
+        key_buf = g_realloc(key_buf, key_buf_size);
+    }
+    /* Returned size includes the terminating '\0' */
+    *len = JSStringGetUTF8CString(key, key_buf, key_buf_size) - 1;
+    return key_buf;
+}
+
+/* Whether a property name is a canonical array index ("0", "1", ... ) */
+static gboolean
+key_is_index(const gchar *key, size_t len, gint *idx)
+{
+    if (len == 0 || len > 9 || (key[0] == '0' && len > 1))
+        return FALSE;
+    gint n = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (key[i] < '0' || key[i] > '9')
+            return FALSE;
+        n = n * 10 + (key[i] - '0');
+    }
+    *idx = n;
+    return TRUE;
+}
+
+static void
+set_exception_error(JSContextRef context, JSValueRef exception, const gchar *what, gchar **error)
+{
+    if (!error)
+        return;
+    gchar *err = tostring(context, exception, NULL);
+    *error = g_strdup_printf("%s call failed (%s)", what, err ? err : "unknown reason");
+    g_free(err);
+}
+
+/* Push the contents of an ArrayBuffer or typed array as a Lua string */
+static gboolean
+luaJS_pushbuffer(lua_State *L, JSContextRef context, JSObjectRef obj)
+{
+    JSTypedArrayType type = JSValueGetTypedArrayType(context, obj, NULL);
+    const guint8 *bytes;
+    size_t len;
+
+    switch (type) {
+      case kJSTypedArrayTypeNone:
+        return FALSE;
+      case kJSTypedArrayTypeArrayBuffer:
+        bytes = JSObjectGetArrayBufferBytesPtr(context, obj, NULL);
+        len = JSObjectGetArrayBufferByteLength(context, obj, NULL);
+        break;
+      case kJSTypedArrayTypeUint8Array:
+      case kJSTypedArrayTypeUint8ClampedArray:
+      case kJSTypedArrayTypeInt8Array:
+        bytes = JSObjectGetTypedArrayBytesPtr(context, obj, NULL);
+        bytes += JSObjectGetTypedArrayByteOffset(context, obj, NULL);
+        len = JSObjectGetTypedArrayByteLength(context, obj, NULL);
+        break;
+      default:
+        /* Wider typed arrays are converted element-wise */
+        return FALSE;
+    }
+
+    lua_pushlstring(L, bytes ? (const gchar *)bytes : "", bytes ? len : 0);
+    return TRUE;
+}
+
+/* Arrays longer than this are checked for holes before being converted by
+ * index, so that e.g. `new Array(1e9)` doesn't allocate a huge table */
+#define LUAJS_SPARSE_ARRAY_CHECK 1024
+/* The number of evenly spaced indices probed by that check */
+#define LUAJS_SPARSE_ARRAY_PROBES 16
+
+static gboolean
+array_has_index(JSContextRef context, JSObjectRef obj, guint idx)
+{
+    gchar buf[16];
+    g_snprintf(buf, sizeof(buf), "%u", idx);
+    JSStringRef name = JSStringCreateWithUTF8CString(buf);
+    gboolean ret = JSObjectHasProperty(context, obj, name);
+    JSStringRelease(name);
+    return ret;
+}
+
+/* Whether a long array looks sparse: probing a few indices, including the
+ * last one, is much cheaper than copying all property names */
+static gboolean
+array_is_sparse(JSContextRef context, JSObjectRef obj, guint len)
+{
+    for (guint i = 0; i < LUAJS_SPARSE_ARRAY_PROBES; i++) {
+        guint idx = (guint)((guint64)(len - 1) * i / (LUAJS_SPARSE_ARRAY_PROBES - 1));
+        if (!array_has_index(context, obj, idx))
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/* Convert a true JavaScript array using its length and indexed gets;
+ * returns -1 for sparse arrays, which are converted like other objects.
+ * Only the elements are converted: other properties set on the array are
+ * ignored. */
+static gint
+luaJS_pusharray(lua_State *L, JSContextRef context, JSObjectRef obj, luajs_convert_t *conv, gchar **error)
+{
+    JSValueRef exception = NULL;
+    JSStringRef length_str = JSStringCreateWithUTF8CString("length");
+    JSValueRef length_val = JSObjectGetProperty(context, obj, length_str, &exception);
+    JSStringRelease(length_str);
+    if (exception) {
+        set_exception_error(context, exception, "JSObjectGetProperty", error);
+        return 0;
+    }
+    guint len = JSValueToNumber(context, length_val, NULL);
+
+    if (len > LUAJS_SPARSE_ARRAY_CHECK && array_is_sparse(context, obj, len))
+        return -1;
+
+    lua_createtable(L, len, 0);
+    for (guint i = 0; i < len; i++) {
+        JSValueRef val = JSObjectGetPropertyAtIndex(context, obj, i, &exception);
+        if (exception) {
+            lua_pop(L, 1);
+            set_exception_error(context, exception, "JSObjectGetPropertyAtIndex", error);
+            return 0;
+        }
+        if (!luaJS_pushvalue_r(L, context, val, conv, error)) {
+            lua_pop(L, 1);
+            return 0;
+        }
+        lua_rawseti(L, -2, i + 1);
+    }
+    return 1;
+}
+
+static gint
+luaJS_pushobject_r(lua_State *L, JSContextRef context, JSObjectRef obj, luajs_convert_t *conv, gchar **error)
+{
+    if (luaJS_pushbuffer(L, context, obj))
+        return 1;
+
+    for (guint i = 0; i < conv->depth; i++) {
+        if (conv->path[i] == obj) {
+            if (error)
+                *error = g_strdup("unable to convert cyclic object");
+            return 0;
+        }
+    }
+    if (conv->depth == LUAJS_MAX_DEPTH || !lua_checkstack(L, 4)) {
+        if (error)
+            *error = g_strdup("object nesting too deep to convert");
+        return 0;
+    }
+
+    conv->path[conv->depth++] = obj;
+    gint ret;
+
+    if (JSValueIsArray(context, obj)) {
+        ret = luaJS_pusharray(L, context, obj, conv, error);
+        if (ret >= 0) {
+            conv->depth--;
+            return ret;
+        }
+    }
 
+    gint top = lua_gettop(L);
     JSPropertyNameArrayRef keys = JSObjectCopyPropertyNames(context, obj);
     size_t count = JSPropertyNameArrayGetCount(keys);
     JSValueRef exception = NULL;
 
-    lua_newtable(L);
+    lua_createtable(L, 0, count);
 
     for (size_t i = 0; i < count; i++) {
         /* push table key onto stack */
         JSStringRef key = JSPropertyNameArrayGetNameAtIndex(keys, i);
-        size_t slen = JSStringGetMaximumUTF8CStringSize(key);
-        gchar cstr[slen];
-        JSStringGetUTF8CString(key, cstr, slen);
-
-        gchar *eptr = NULL;
-        int n = strtol(cstr, &eptr, 10);
-        if (!*eptr) /* end at '\0' ? == it's a number! */
-            lua_pushinteger(L, ++n); /* 0-index array to 1-index array */
+        size_t len;
+        const gchar *cstr = key_to_utf8(key, &len);
+        gint n;
+        if (key_is_index(cstr, len, &n))
+            lua_pushinteger(L, n + 1); /* 0-index array to 1-index array */
         else
-            lua_pushstring(L, cstr);
+            lua_pushlstring(L, cstr, len);
 
         /* push table value into stack */
         JSValueRef val = JSObjectGetProperty(context, obj, key, &exception);
         if (exception) {
-            lua_settop(L, top);
-            if (error) {
-                gchar *err = tostring(context, exception, NULL);
-                *error = g_strdup_printf("JSObjectGetProperty call failed (%s)",
-                        err ? err : "unknown reason");
-                g_free(err);
-            }
-            JSPropertyNameArrayRelease(keys);
-            return 0;
-        }
-        luaJS_pushvalue(L, context, val, error);
-        if (error && *error) {
-            lua_settop(L, top);
-            JSPropertyNameArrayRelease(keys);
-            return 0;
+            set_exception_error(context, exception, "JSObjectGetProperty", error);
+            break;
         }
+        if (!luaJS_pushvalue_r(L, context, val, conv, error))
+            break;
         lua_rawset(L, -3);
     }
     JSPropertyNameArrayRelease(keys);
-    return 1;
+    conv->depth--;
+
+    ret = lua_gettop(L) == top + 1;
+    if (!ret)
+        lua_settop(L, top);
+    return ret;
 }
 
 /* Push JavaScript value onto Lua stack */
-gint
-luaJS_pushvalue(lua_State *L, JSContextRef context, JSValueRef value, gchar **error)
+static gint
+luaJS_pushvalue_r(lua_State *L, JSContextRef context, JSValueRef value, luajs_convert_t *conv, gchar **error)
 {
     switch (JSValueGetType(context, value)) {
       case kJSTypeBoolean:
@@ -113,7 +283,7 @@ luaJS_pushvalue(lua_State *L, JSContextRef context, JSValueRef value, gchar **er
         return luaJS_pushstring(L, context, value, error);
 
       case kJSTypeObject:
-        return luaJS_pushobject(L, context, (JSObjectRef)value, error);
+        return luaJS_pushobject_r(L, context, (JSObjectRef)value, conv, error);
 
       case kJSTypeUndefined:
       case kJSTypeNull:
@@ -128,6 +298,20 @@ luaJS_pushvalue(lua_State *L, JSContextRef context, JSValueRef value, gchar **er
     return 0;
 }
 
+gint
+luaJS_pushobject(lua_State *L, JSContextRef context, JSObjectRef obj, gchar **error)
+{
+    luajs_convert_t conv = { .depth = 0 };
+    return luaJS_pushobject_r(L, context, obj, &conv, error);
+}
+
+gint
+luaJS_pushvalue(lua_State *L, JSContextRef context, JSValueRef value, gchar **error)
+{
+    luajs_convert_t conv = { .depth = 0 };
+    return luaJS_pushvalue_r(L, context, value, &conv, error);
+}
+
 JSValueRef
 luaJS_fromtable(lua_State *L, JSContextRef context, gint idx, gchar **error)
 {
@@ -142,7 +326,20 @@ luaJS_fromtable(lua_State *L, JSContextRef context, gint idx, gchar **error)
 
     size_t len = lua_objlen(L, idx);
     if (len) {
-        obj = JSObjectMakeArray(context, 0, NULL, &exception);
+        /* Convert the array part in order, then build the array in one go;
+         * any other keys of the table are ignored */
+        JSValueRef *vals = g_new(JSValueRef, len);
+        for (size_t i = 0; i < len; i++) {
+            lua_rawgeti(L, idx, i + 1);
+            vals[i] = luaJS_tovalue(L, context, -1, error);
+            lua_pop(L, 1);
+            if (error && *error) {
+                g_free(vals);
+                return NULL;
+            }
+        }
+        obj = JSObjectMakeArray(context, len, vals, &exception);
+        g_free(vals);
         if (exception) {
             if (error) {
                 gchar *err = tostring(context, exception, NULL);
@@ -152,17 +349,6 @@ luaJS_fromtable(lua_State *L, JSContextRef context, gint idx, gchar **error)
             }
             return NULL;
         }
-
-        lua_pushnil(L);
-        for (guint i = 0; lua_next(L, idx); i++) {
-            JSValueRef val = luaJS_tovalue(L, context, -1, error);
-            if (error && *error) {
-                lua_settop(L, top);
-                return NULL;
-            }
-            lua_pop(L, 1);
-            JSObjectSetPropertyAtIndex(context, obj, i, val, &exception);
-        }
     } else {
         obj = JSObjectMake(context, NULL, NULL);
         lua_pushnil(L);
@@ -243,8 +429,47 @@ luaJS_make_exception(JSContextRef context, const gchar *error)
     return JSValueToObject(context, exception, NULL);
 }
 
+/* Push the result of evaluated JavaScript in the requested format */
+gint
+luaJS_pushresult(lua_State *L, JSContextRef context, JSValueRef value, luajs_result_format_t format, gchar **error)
+{
+    switch (format) {
+      case LUAJS_RESULT_JSON: {
+        JSValueRef exception = NULL;
+        JSStringRef json = JSValueCreateJSONString(context, value, 0, &exception);
+        if (exception) {
+            set_exception_error(context, exception, "JSValueCreateJSONString", error);
+            return 0;
+        }
+        /* undefined and functions have no JSON representation */
+        if (!json) {
+            lua_pushnil(L);
+            return 1;
+        }
+        size_t size = JSStringGetMaximumUTF8CStringSize(json);
+        gchar *cstr = g_malloc(size);
+        size_t len = JSStringGetUTF8CString(json, cstr, size) - 1;
+        lua_pushlstring(L, cstr, len);
+        g_free(cstr);
+        JSStringRelease(json);
+        return 1;
+      }
+      case LUAJS_RESULT_BINARY:
+        if (JSValueIsString(context, value))
+            return luaJS_pushstring(L, context, value, error);
+        if (JSValueIsObject(context, value)
+                && luaJS_pushbuffer(L, context, (JSObjectRef)value))
+            return 1;
+        if (error)
+            *error = g_strdup("result is not a string, ArrayBuffer or byte array");
+        return 0;
+      default:
+        return luaJS_pushvalue(L, context, value, error);
+    }
+}
+
 gint
-luaJS_eval_js(lua_State *L, JSContextRef context, const gchar *script, const gchar *source, bool no_return)
+luaJS_eval_js(lua_State *L, JSContextRef context, const gchar *script, const gchar *source, bool no_return, luajs_result_format_t format)
 {
 
     JSStringRef js_script;
@@ -272,7 +497,7 @@ luaJS_eval_js(lua_State *L, JSContextRef context, const gchar *script, const gch
 
     /* push return value onto lua stack */
     gchar *error = NULL;
-    if (luaJS_pushvalue(L, context, result, &error))
+    if (luaJS_pushresult(L, context, result, format, &error))
         return 1;
 
     /* handle type conversion errors */
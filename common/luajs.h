@@ -24,6 +24,13 @@
 #include <glib.h>
 #include <lua.h>
 
+/* How the result of evaluated JavaScript is returned to Lua */
+typedef enum {
+    LUAJS_RESULT_LUA,     /* converted into a Lua value */
+    LUAJS_RESULT_JSON,    /* serialized with JSON.stringify() */
+    LUAJS_RESULT_BINARY,  /* contents of a string, ArrayBuffer or typed array */
+} luajs_result_format_t;
+
 gchar* tostring(JSContextRef context, JSValueRef value, gchar **error);
 gint luaJS_pushstring(lua_State *L, JSContextRef context, JSValueRef value, gchar **error);
 gint luaJS_pushobject(lua_State *L, JSContextRef context, JSObjectRef obj, gchar **error);
@@ -31,8 +38,9 @@ gint luaJS_pushvalue(lua_State *L, JSContextRef context, JSValueRef value, gchar
 JSValueRef luaJS_fromtable(lua_State *L, JSContextRef context, gint idx, gchar **error);
 JSValueRef luaJS_tovalue(lua_State *L, JSContextRef context, gint idx, gchar **error);
 JSValueRef luaJS_make_exception(JSContextRef context, const gchar *error);
+gint luaJS_pushresult(lua_State *L, JSContextRef context, JSValueRef value, luajs_result_format_t format, gchar **error);
 
-gint luaJS_eval_js(lua_State *L, JSContextRef context, const gchar *script, const gchar *source, bool no_return);
+gint luaJS_eval_js(lua_State *L, JSContextRef context, const gchar *script, const gchar *source, bool no_return, luajs_result_format_t format);
 
 #endif /* end of include guard: LUAKIT_COMMON_LUAJS_H */
 
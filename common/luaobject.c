@@ -20,6 +20,7 @@
  */
 
 #include "common/luaobject.h"
+#include "common/trace.h"
 
 /* Setup the object system at startup. */
 void
@@ -307,10 +308,14 @@ signal_object_emit(lua_State *L, signal_t *signals,
  * adjustment.
  * 0 means that all return values are removed and that ALL handler functions are
  * executed.
+ * `filter`, if not NULL, is called with each handler function and
+ * `filter_data` before any handler is run; handlers it returns FALSE for
+ * are skipped.
  * Returns the number of return values pushed onto the stack. */
-gint
-luaH_object_emit_signal(lua_State *L, gint oud,
-        const gchar *name, gint nargs, gint nret) {
+static gint
+object_emit_signal(lua_State *L, gint oud,
+        const gchar *name, gint nargs, gint nret,
+        signal_filter_t filter, gpointer filter_data) {
     gint ret, top, bot = lua_gettop(L) - nargs + 1;
     gint oud_abs = luaH_absindex(L, oud);
     lua_object_t *obj = lua_touserdata(L, oud);
@@ -329,13 +334,17 @@ luaH_object_emit_signal(lua_State *L, gint oud,
 
     signal_array_t *sigfuncs = signal_lookup(obj->signals, name);
     if (sigfuncs) {
-        guint nbfunc = sigfuncs->len;
-        luaL_checkstack(L, lua_gettop(L) + nbfunc + nargs + 2,
+        guint nbfunc = 0;
+        luaL_checkstack(L, lua_gettop(L) + sigfuncs->len + nargs + 2,
                 "too many signal handlers; need a new implementation!");
         /* Push all functions and then execute, because this list can change
          * while executing funcs. */
-        for (guint i = 0; i < nbfunc; i++)
+        for (guint i = 0; i < sigfuncs->len; i++) {
+            if (filter && !filter(sigfuncs->pdata[i], filter_data))
+                continue;
             luaH_object_push_item(L, oud_abs, sigfuncs->pdata[i]);
+            nbfunc++;
+        }
 
         for (guint i = 0; i < nbfunc; i++) {
             /* push object */
@@ -383,6 +392,34 @@ luaH_object_emit_signal(lua_State *L, gint oud,
     return 0;
 }
 
+/* Emit a signal to an object, calling only the handlers that `filter`
+ * returns TRUE for; see object_emit_signal(). */
+gint
+luaH_object_emit_signal_filtered(lua_State *L, gint oud,
+        const gchar *name, gint nargs, gint nret,
+        signal_filter_t filter, gpointer filter_data) {
+    if (!trace_enabled)
+        return object_emit_signal(L, oud, name, nargs, nret, filter, filter_data);
+
+    /* Only trace signals that have handlers */
+    lua_object_t *obj = lua_touserdata(L, oud);
+    if (!obj || !signal_lookup(obj->signals, name))
+        return object_emit_signal(L, oud, name, nargs, nret, filter, filter_data);
+
+    gchar *signame = g_strdup(name);
+    gint64 start = trace_now();
+    gint ret = object_emit_signal(L, oud, name, nargs, nret, filter, filter_data);
+    trace_span("signal", signame, start);
+    g_free(signame);
+    return ret;
+}
+
+gint
+luaH_object_emit_signal(lua_State *L, gint oud,
+        const gchar *name, gint nargs, gint nret) {
+    return luaH_object_emit_signal_filtered(L, oud, name, nargs, nret, NULL, NULL);
+}
+
 gint
 luaH_object_property_signal(lua_State *L, gint oud, luakit_token_t tok)
 {
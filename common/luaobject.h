@@ -164,6 +164,13 @@ void luaH_object_remove_signal(lua_State *L, gint oud,
 gint luaH_object_emit_signal(lua_State *L, gint oud,
         const gchar *name, gint nargs, gint nret);
 
+/** Called with each handler function of a filtered signal emission; returns
+ * whether the handler should be called */
+typedef gboolean (*signal_filter_t)(gpointer handler, gpointer data);
+gint luaH_object_emit_signal_filtered(lua_State *L, gint oud,
+        const gchar *name, gint nargs, gint nret,
+        signal_filter_t filter, gpointer filter_data);
+
 gint luaH_object_add_signal_simple(lua_State *L);
 gint luaH_object_remove_signal_simple(lua_State *L);
 gint luaH_object_remove_signals_simple(lua_State *L);
@@ -214,6 +214,87 @@ lua_serialize_range(lua_State *L, GByteArray *out, int start, int end)
         lua_serialize_value(L, out, i);
 }
 
+/* Maximum table nesting accepted by lua_serialized_data_validate() */
+#define LUA_SERIALIZED_MAX_DEPTH 100
+
+static gboolean
+lua_serialized_data_validate_value(const guint8 **bytes, const guint8 *end, gint depth, gint8 *type_out)
+{
+#define NEED(length) \
+    if ((size_t)(end - *bytes) < (length)) return FALSE;
+
+    gint8 type;
+    NEED(sizeof(type));
+    memcpy(&type, *bytes, sizeof(type));
+    *bytes += sizeof(type);
+    *type_out = type;
+
+    switch (type) {
+        case LUA_TNIL:
+        case LUA_TNONE:
+            return TRUE;
+        case LUA_TNUMBER:
+            NEED(sizeof(lua_Number));
+            *bytes += sizeof(lua_Number);
+            return TRUE;
+        case LUA_TBOOLEAN:
+            NEED(sizeof(gint8));
+            *bytes += sizeof(gint8);
+            return TRUE;
+        case LUA_TSTRING: {
+            size_t len;
+            NEED(sizeof(len));
+            memcpy(&len, *bytes, sizeof(len));
+            *bytes += sizeof(len);
+            NEED(len);
+            NEED(len + 1);
+            if ((*bytes)[len] != '\0')
+                return FALSE;
+            *bytes += len + 1;
+            return TRUE;
+        }
+        case LUA_TTABLE: {
+            if (depth >= LUA_SERIALIZED_MAX_DEPTH)
+                return FALSE;
+            gint8 key_type, value_type;
+            while (TRUE) {
+                if (!lua_serialized_data_validate_value(bytes, end, depth + 1, &key_type))
+                    return FALSE;
+                if (key_type == LUA_TNONE)
+                    return TRUE;
+                if (key_type == LUA_TNIL)
+                    return FALSE;
+                if (!lua_serialized_data_validate_value(bytes, end, depth + 1, &value_type))
+                    return FALSE;
+                if (value_type == LUA_TNONE)
+                    return FALSE;
+            }
+        }
+        default:
+            /* Functions and pointers are never accepted from untrusted data */
+            return FALSE;
+    }
+#undef NEED
+}
+
+/* Check that a buffer contains only complete, serialized plain data values
+ * (nil, numbers, booleans, strings and tables of these), so that it can be
+ * safely deserialized even if it was read from disk */
+gboolean
+lua_serialized_data_validate(const guint8 *in, guint length)
+{
+    const guint8 *bytes = in, *end = in + length;
+    gint8 type;
+
+    while (bytes < end) {
+        if (!lua_serialized_data_validate_value(&bytes, end, 0, &type))
+            return FALSE;
+        if (type == LUA_TNONE)
+            return FALSE;
+    }
+    return TRUE;
+}
+
 int
 lua_deserialize_range(lua_State *L, const guint8 *in, guint length)
 {
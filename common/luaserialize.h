@@ -24,6 +24,7 @@
 
 void lua_serialize_range(lua_State *L, GByteArray *out, gint start, gint end);
 int lua_deserialize_range(lua_State *L, const guint8 *in, guint length);
+gboolean lua_serialized_data_validate(const guint8 *in, guint length);
 
 #endif
 
@@ -165,4 +165,52 @@ luaH_gobject_newindex(lua_State *L, property_t *props, luakit_token_t tok,
     return FALSE;
 }
 
+/* Like luaH_gobject_newindex(), but only sets the property if its value
+ * differs from the current one. Returns -1 if the property was not found or
+ * is read-only, 0 if it was unchanged, and 1 if it was set. */
+gint
+luaH_gobject_update(lua_State *L, property_t *props, luakit_token_t tok,
+        gint vidx, GObject *object)
+{
+    property_t *p;
+    for (p = props; p->tok && p->tok != tok; p++);
+    if (!p->tok)
+        return -1;
+    if (!p->writable) {
+        warn("read-only property: %s", p->name);
+        return -1;
+    }
+
+    property_tmp_t tmp;
+    gboolean same;
+
+#define TU_CASE(type, cast, dest, cfunc)                 \
+      case type:                                         \
+        g_object_get(object, p->name, &(dest), NULL);    \
+        same = (dest) == (cast)cfunc(L, vidx);           \
+        break;
+
+    switch(p->type) {
+      TU_CASE(BOOL,   gboolean, tmp.b, luaH_checkboolean);
+      TU_CASE(INT,    gint,     tmp.i, luaL_checknumber);
+      TU_CASE(FLOAT,  gfloat,   tmp.f, luaL_checknumber);
+      TU_CASE(DOUBLE, gdouble,  tmp.d, luaL_checknumber);
+
+      case CHAR:
+        g_object_get(object, p->name, &tmp.c, NULL);
+        same = !g_strcmp0(tmp.c, lua_isnil(L, vidx) ? NULL : luaL_checkstring(L, vidx));
+        g_free(tmp.c);
+        break;
+
+      default:
+        same = FALSE;
+        break;
+    }
+
+    if (same)
+        return 0;
+    luaH_gobject_set(L, p, vidx, object);
+    return 1;
+}
+
 // vim: ft=c:et:sw=4:ts=8:sts=4:tw=80
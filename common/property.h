@@ -53,6 +53,8 @@ typedef struct {
 gint luaH_gobject_index(lua_State *, property_t *, luakit_token_t, GObject *);
 gboolean luaH_gobject_newindex(lua_State *, property_t *, luakit_token_t,
         gint, GObject *);
+gint luaH_gobject_update(lua_State *, property_t *, luakit_token_t,
+        gint, GObject *);
 
 #endif
 
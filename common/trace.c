@@ -0,0 +1,228 @@
+/*
+ * common/trace.c - startup trace recording
+ *
+ * Copyright © 2026 luakit developers
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Events are recorded in the Chrome trace event format, and can be viewed
+ * with chrome://tracing or https://ui.perfetto.dev. Timestamps come from the
+ * monotonic clock, which is shared by the UI and web processes, so events
+ * recorded by web processes are simply merged into the UI process trace. */
+
+#include "common/trace.h"
+#include "common/log.h"
+#include "common/util.h"
+
+#include <lauxlib.h>
+#include <unistd.h>
+
+gboolean trace_enabled;
+
+/* Recorded events, as comma-separated JSON objects */
+static GString *events;
+/* Where the UI process writes the trace, and the number of milestones left
+ * until startup is considered complete */
+static gchar *trace_path;
+static guint milestones_left;
+
+static void
+append_json_string(GString *str, const gchar *s)
+{
+    g_string_append_c(str, '"');
+    for (; *s; s++) {
+        guchar c = *s;
+        if (c == '"' || c == '\\')
+            g_string_append_printf(str, "\\%c", c);
+        else if (c < 0x20)
+            g_string_append_printf(str, "\\u%04x", c);
+        else
+            g_string_append_c(str, c);
+    }
+    g_string_append_c(str, '"');
+}
+
+static void
+append_event(const gchar *ph, const gchar *cat, const gchar *name, gint64 ts)
+{
+    if (events->len)
+        g_string_append_c(events, ',');
+    g_string_append(events, "\n{\"name\":");
+    append_json_string(events, name);
+    g_string_append(events, ",\"cat\":");
+    append_json_string(events, cat);
+    /* Lua only runs on the main thread, so its id is the process id */
+    g_string_append_printf(events, ",\"ph\":\"%s\",\"pid\":%d,\"tid\":%d,\"ts\":%" G_GINT64_FORMAT,
+            ph, getpid(), getpid(), ts);
+}
+
+/** Start recording trace events.
+ *
+ * \param process_name The process name shown in the trace.
+ * \param path         The file to write the trace to, or NULL for web
+ *                     processes, whose events are sent to the UI process.
+ * \param milestones   The number of trace_milestone() calls after which
+ *                     startup is complete and the trace is written.
+ */
+void
+trace_init(const gchar *process_name, const gchar *path, guint milestones)
+{
+    events = g_string_new(NULL);
+    trace_path = g_strdup(path);
+    milestones_left = milestones;
+    trace_enabled = TRUE;
+
+    g_string_append_printf(events, "\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":", getpid());
+    append_json_string(events, process_name);
+    g_string_append(events, "}}");
+}
+
+gint64
+trace_now(void)
+{
+    return g_get_monotonic_time();
+}
+
+/** Record a complete event, from \p start until now. */
+void
+trace_span(const gchar *cat, const gchar *name, gint64 start)
+{
+    if (!trace_enabled)
+        return;
+    gint64 now = trace_now();
+    append_event("X", cat, name, start);
+    g_string_append_printf(events, ",\"dur\":%" G_GINT64_FORMAT "}", now - start);
+}
+
+/** Record an instant event. */
+void
+trace_mark(const gchar *cat, const gchar *name)
+{
+    if (!trace_enabled)
+        return;
+    append_event("i", cat, name, trace_now());
+    g_string_append(events, ",\"s\":\"p\"}");
+}
+
+static gboolean
+trace_finish_cb(gpointer UNUSED(user_data))
+{
+    trace_finish();
+    return G_SOURCE_REMOVE;
+}
+
+/** Record a startup milestone. Once all milestones have been reached, the
+ * trace is written after a short delay, so that trace events from web
+ * processes can arrive. */
+void
+trace_milestone(const gchar *name)
+{
+    if (!trace_enabled || !milestones_left)
+        return;
+    trace_mark("startup", name);
+    if (!--milestones_left && trace_path)
+        g_timeout_add_seconds(1, trace_finish_cb, NULL);
+}
+
+/** Add events recorded by another process. */
+void
+trace_add_events(const gchar *str, gsize length)
+{
+    if (!trace_enabled || !length)
+        return;
+    if (events->len)
+        g_string_append_c(events, ',');
+    g_string_append_len(events, str, length);
+}
+
+/** Take the events recorded so far, to send them to another process.
+ * \return The events, or NULL if there are none; free with g_free(). */
+gchar *
+trace_take_events(void)
+{
+    if (!trace_enabled || !events->len)
+        return NULL;
+    gchar *ret = g_strdup(events->str);
+    g_string_truncate(events, 0);
+    return ret;
+}
+
+/** Stop recording, and write the trace file if this process owns one. */
+void
+trace_finish(void)
+{
+    if (!trace_enabled)
+        return;
+    trace_enabled = FALSE;
+
+    if (trace_path) {
+        GString *out = g_string_new("{\"traceEvents\":[");
+        g_string_append_len(out, events->str, events->len);
+        g_string_append(out, "\n]}\n");
+        GError *err = NULL;
+        if (g_file_set_contents(trace_path, out->str, out->len, &err))
+            info("wrote startup trace to '%s'", trace_path);
+        else {
+            error("unable to write startup trace: %s", err->message);
+            g_error_free(err);
+        }
+        g_string_free(out, TRUE);
+        g_free(trace_path);
+        trace_path = NULL;
+    }
+
+    g_string_free(events, TRUE);
+    events = NULL;
+}
+
+static gint
+luaH_trace_require(lua_State *L)
+{
+    const gchar *name = luaL_checkstring(L, 1);
+    gint64 start = trace_now();
+
+    /* Only trace the first, loading, require of each module */
+    lua_getfield(L, LUA_REGISTRYINDEX, "_LOADED");
+    lua_getfield(L, -1, name);
+    gchar *loading = lua_toboolean(L, -1) ? NULL : g_strdup(name);
+    lua_pop(L, 2);
+
+    lua_pushvalue(L, lua_upvalueindex(1));
+    lua_insert(L, 1);
+    gint status = lua_pcall(L, lua_gettop(L) - 1, LUA_MULTRET, 0);
+
+    /* Record failed loads too, then re-raise the error */
+    if (loading) {
+        trace_span("require", loading, start);
+        g_free(loading);
+    }
+    if (status)
+        lua_error(L);
+    return lua_gettop(L);
+}
+
+/** Wrap require() so that module loads are recorded. */
+void
+luaH_trace_setup(lua_State *L)
+{
+    if (!trace_enabled)
+        return;
+    lua_getglobal(L, "require");
+    lua_pushcclosure(L, luaH_trace_require, 1);
+    lua_setglobal(L, "require");
+}
+
+// vim: ft=c:et:sw=4:ts=8:sts=4:tw=80
@@ -0,0 +1,42 @@
+/*
+ * common/trace.h - startup trace recording
+ *
+ * Copyright © 2026 luakit developers
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LUAKIT_COMMON_TRACE_H
+#define LUAKIT_COMMON_TRACE_H
+
+#include <lua.h>
+#include <glib.h>
+
+/** Whether trace events are being recorded in this process */
+extern gboolean trace_enabled;
+
+void trace_init(const gchar *process_name, const gchar *path, guint milestones);
+gint64 trace_now(void);
+void trace_span(const gchar *cat, const gchar *name, gint64 start);
+void trace_mark(const gchar *cat, const gchar *name);
+void trace_milestone(const gchar *name);
+void trace_add_events(const gchar *events, gsize length);
+gchar *trace_take_events(void);
+void trace_finish(void);
+void luaH_trace_setup(lua_State *L);
+
+#endif /* end of include guard: LUAKIT_COMMON_TRACE_H */
+
+// vim: ft=c:et:sw=4:ts=8:sts=4:tw=80
@@ -106,6 +106,9 @@ local tabhistory = require "tabhistory"
 -- Add command to list open tabs
 local tabmenu = require "tabmenu"
 
+-- Discard idle background tabs (see the tab_discard.* settings)
+local tab_discard = require "tab_discard"
+
 -- Allow for tabs to be grouped together.
 -- One tab group is displayed in a window at any given time.
 --local tabgroups = require "tabgroups"
@@ -84,6 +84,61 @@
 -- @treturn string A string containig data printed on `stderr`.
 -- @function spawn_sync
 
+--- Replace the contents of a file without blocking the main thread.
+--
+-- The file is written on a background thread to a temporary file, which is
+-- then renamed into place, so readers never see a partially written file.
+-- Writes to the same path made within `delay` milliseconds of the first are
+-- coalesced, and only the most recent contents are written. Pending writes
+-- are completed when luakit exits.
+--
+-- @function save_file_async
+-- @tparam string path The path of the file to write.
+-- @tparam string contents The new contents of the file.
+-- @tparam[opt] integer delay The time in milliseconds to wait for further
+-- writes; defaults to 500.
+
+--- Append to a file without blocking the main thread.
+--
+-- Appends are made on the same background thread as @ref{save_file_async},
+-- and are coalesced with other pending writes to the same path.
+--
+-- @function append_file_async
+-- @tparam string path The path of the file to append to.
+-- @tparam string contents The data to append.
+-- @tparam[opt] integer delay The time in milliseconds to wait for further
+-- writes; defaults to 500.
+
+--- Serialize plain data values into a compact binary string.
+--
+-- Values may be `nil`, numbers, booleans, strings, and tables of these. Each
+-- value is stored as a separate length-prefixed record, so the results of
+-- several calls can be concatenated or appended to a file, and read back with
+-- @ref{deserialize}. The format is specific to the machine it was written on.
+--
+-- @function serialize
+-- @param ... The values to serialize.
+-- @treturn string The serialized records.
+
+--- Deserialize records made with @ref{serialize}.
+--
+-- Decoding stops at the first truncated or invalid record, so a partially
+-- written file can still be read.
+--
+-- @function deserialize
+-- @tparam string data The serialized records.
+-- @treturn table An array of the decoded values.
+-- @treturn integer The length in bytes of the data that was decoded.
+
+--- Complete pending writes made with @ref{save_file_async}, and wait for the
+-- writes in progress to finish. If a path is given, only writes to that path
+-- are waited for. Call this before reading back a file that may have been
+-- written asynchronously.
+--
+-- @function flush_file_writes
+-- @tparam[opt] string path The path to flush; if omitted, all pending writes
+-- are flushed.
+
 --- Get the time since Luakit startup.
 -- @function time
 -- @treturn number The number of seconds Luakit has been running.
@@ -128,6 +183,24 @@
 -- @treturn boolean `true` if the callback was present (and removed); `false` if the
 -- callback was not found.
 
+--- Register a JavaScript snippet for repeated use with `webview:eval_js()`.
+--
+-- The script is sent to every web process once, and is compiled the first
+-- time it is run on a page as the body of a function; use `return` to return
+-- a value. The compiled function is reused until the page navigates, which
+-- avoids re-sending and re-parsing large scripts on every call.
+--
+-- @function register_js
+-- @tparam string script The JavaScript function body.
+-- @tparam[opt] table options Additional options: `source`, a string to be used
+-- in error messages, and `args`, an array of argument names.
+-- @treturn integer A handle that can be passed to `webview:eval_js()`.
+
+--- Unregister a script previously registered with @ref{register_js}.
+--
+-- @function unregister_js
+-- @tparam integer handle The handle of the script to unregister.
+
 --- Register a custom URI scheme.
 --
 -- Registering a scheme causes network requests to that scheme to be redirected
@@ -231,4 +304,13 @@
 --- Clear the favicon cache database.
 -- @function clear_favicon_database
 
+--- Get statistics about the in-memory cache of scaled favicons shared by
+-- image widgets.
+--
+-- The returned table has the fields `size` (the number of cached favicons),
+-- `hits`, `misses`, `evictions`, and `hit_rate` (the fraction of lookups that
+-- were hits).
+-- @treturn table The cache statistics.
+-- @function favicon_cache_stats
+
 -- vim: et:sw=4:ts=8:sts=4:tw=80
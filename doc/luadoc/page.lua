@@ -39,17 +39,68 @@
 --
 -- # Modifying HTTP headers
 --
--- To modify the HTTP headers sent with the request, modify the `headers` table.
+-- To modify the HTTP headers sent with the request, modify the `headers`
+-- object. Header names are case-insensitive, and only headers that are
+-- assigned to are changed.
 --
 --     page:add_signal("send-request", function (_, _, headers)
 -- 	    headers.Referer = nil -- Don't send Referer header
 -- 	end)
+--
+-- The `headers` object is a lightweight proxy over the request headers, and
+-- is only valid for the duration of the signal emission. To get a plain
+-- table copy of all headers, call it: `headers()`.
 -- @signal send-request
 -- @tparam page page The page.
 -- @tparam string uri The URI of the request.
--- @tparam table headers The HTTP headers of the request.
+-- @tparam userdata headers The HTTP headers of the request.
 -- @treturn string|false A redirect URI, or `false` to block the request.
 
+--- @function add_request_filter
+-- Register a native pre-filter for a `send-request` signal handler.
+--
+-- A handler with filters is only called for requests that match at least
+-- one of its filters; handlers without filters see every request. If no
+-- connected handler is interested in a request, it is sent without
+-- entering Lua at all. Since filters belong to a handler function, connect
+-- the same function to each page:
+--
+--     local function on_send_request (page, uri, headers) ... end
+--     page.add_request_filter({ schemes = { "http", "https" } }, on_send_request)
+--     luakit.add_signal("page-created", function (page)
+--         page:add_signal("send-request", on_send_request)
+--     end)
+--
+-- All fields are optional, and all given fields must match:
+--
+-- - `schemes`: an array of URI schemes, such as `"https"`.
+-- - `domains`: an array of domains; the request host must be one of them
+--   or a subdomain of one of them.
+-- - `third_party`: if `true`, only match requests whose host is neither a
+--   subdomain nor a superdomain of the page host.
+-- - `headers`: an array of header names; at least one must be present.
+-- - `patterns`: an array of regular expressions matched against the
+--   request URI; they are compiled once, into a single pattern set.
+--
+-- An empty `schemes`, `domains` or `headers` array matches no request.
+--
+-- @tparam table filter The filter description.
+-- @tparam function handler The `send-request` handler the filter applies to.
+-- @treturn integer An identifier that can be passed to `remove_request_filter`.
+
+--- @function remove_request_filter
+-- Remove a filter previously registered with `add_request_filter`.
+-- @tparam integer id The identifier of the filter.
+-- @treturn boolean `true` if the filter was found and removed.
+
+--- @function request_filter_stats
+-- Get statistics about `send-request` filtering in this web process.
+--
+-- The returned table has the fields `filters` (number of registered
+-- filters), `emitted` (number of requests passed to Lua) and `skipped`
+-- (number of requests that did not enter Lua).
+-- @treturn table The filtering statistics.
+
 --- The current active URI of the page.
 -- @property uri
 -- @type string
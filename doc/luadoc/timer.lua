@@ -35,6 +35,27 @@
 -- @type integer
 -- @readwrite
 
+--- @property slack
+-- How late the timer may fire, in milliseconds.
+--
+-- All timers share one wakeup: when a timer is due, any other timer that is
+-- due within its slack fires at the same time, instead of waking luakit up
+-- again. Timers with a slack of a second or more may also be delayed to a
+-- whole second, together with other periodic work.
+-- @type integer
+-- @readwrite
+-- @default `0`
+
+--- @property fire_count
+-- The number of times the timer has fired.
+-- @type integer
+-- @readonly
+
+--- @property callback_time
+-- The total time spent in `timeout` signal handlers, in seconds.
+-- @type number
+-- @readonly
+
 --- @property started
 -- Whether the timer is running.
 -- @type boolean
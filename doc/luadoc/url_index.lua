@@ -0,0 +1,59 @@
+--- In-memory URL suggestion index.
+--
+-- This module provides a fast, in-memory index of visited and bookmarked
+-- URLs, ranked by frecency: a score combining how often and how recently
+-- each URL was visited. It is kept up to date by the `history` and
+-- `bookmarks` modules, and used by the `completion` module for history
+-- completion.
+--
+-- Queries match in the same way as history completion: the query is split
+-- on whitespace, and each term must occur, in order, in the lowercase URI
+-- followed by the title.
+--
+-- @module url_index
+-- @copyright 2026 luakit developers
+
+--- @function add
+-- Record visits to a URL, adding it to the index if necessary.
+--
+-- @tparam string uri The URL.
+-- @tparam[opt] string title The page title, if known.
+-- @tparam[opt] integer visits The number of visits to add.
+-- @default 1
+-- @tparam[opt] integer last_visit The time of the last visit, in seconds
+-- since the epoch; the latest visit time recorded is kept.
+-- @default The current time.
+
+--- @function bookmark
+-- Mark a URL as bookmarked, or not. Bookmarked URLs are suggested even if
+-- they have never been visited, and rank higher than other URLs.
+--
+-- @tparam string uri The URL.
+-- @tparam[opt] boolean bookmarked Whether the URL is bookmarked.
+-- @default `true`
+-- @tparam[opt] string title The bookmark title; only used if no page title
+-- is known.
+
+--- @function remove
+-- Forget all visits to a URL.
+--
+-- @tparam string uri The URL.
+
+--- @function clear
+-- Forget all visits to all URLs. Bookmarks are kept.
+
+--- @function size
+-- Get the number of URLs in the index.
+--
+-- @treturn integer The number of visited or bookmarked URLs.
+
+--- @function query
+-- Find the highest ranked URLs matching a query.
+--
+-- @tparam string text The query text.
+-- @tparam[opt] integer limit The maximum number of results.
+-- @default 25
+-- @treturn {table} An array of results, best first; each result has `uri`,
+-- `title`, `text`, `visits`, `last_visit` and `score` fields.
+
+-- vim: et:sw=4:ts=8:sts=4:tw=80
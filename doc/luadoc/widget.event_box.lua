@@ -22,7 +22,8 @@
 -- Emitted when a mouse button was pressed with the cursor inside the event box widget.
 --
 -- @tparam table modifiers An array of strings, one for each modifier key held
--- at the time of the event.
+-- at the time of the event. The table is shared between events and must not
+-- be modified.
 -- @tparam integer button The number of the button pressed, beginning
 -- from `1`; i.e. `1` corresponds to the left mouse button.
 -- @treturn boolean `true` if the event has been handled and should not be
@@ -32,7 +33,8 @@
 -- Emitted when a mouse button was released with the cursor inside the event box widget.
 --
 -- @tparam table modifiers An array of strings, one for each modifier key held
--- at the time of the event.
+-- at the time of the event. The table is shared between events and must not
+-- be modified.
 -- @tparam integer button The number of the button pressed, beginning
 -- from `1`; i.e. `1` corresponds to the left mouse button.
 -- @treturn boolean `true` if the event has been handled and should not be
@@ -42,7 +44,8 @@
 -- Emitted when a mouse button was double-clicked with the cursor inside the event box widget.
 --
 -- @tparam table modifiers An array of strings, one for each modifier key held
--- at the time of the event.
+-- at the time of the event. The table is shared between events and must not
+-- be modified.
 -- @tparam integer button The number of the button pressed, beginning
 -- from `1`; i.e. `1` corresponds to the left mouse button.
 -- @treturn boolean `true` if the event has been handled and should not be
@@ -51,12 +54,14 @@
 --- @signal mouse-enter
 -- Emitted when the mouse cursor enters the event box widget.
 -- @tparam table modifiers An array of strings, one for each modifier key held.
+-- The table is shared between events and must not be modified.
 -- @treturn boolean `true` if the event has been handled and should not be
 -- propagated further.
 
 --- @signal mouse-leave
 -- Emitted when the mouse cursor leaves the event box widget.
 -- @tparam table modifiers An array of strings, one for each modifier key held.
+-- The table is shared between events and must not be modified.
 -- @treturn boolean `true` if the event has been handled and should not be
 -- propagated further.
 
@@ -61,6 +61,7 @@
 --- @signal key-press
 -- Emitted when a key is pressed while the label widget has the input focus.
 -- @tparam table modifiers An array of strings, one for each modifier key held.
+-- The table is shared between events and must not be modified.
 -- @tparam string key The key that was pressed, if printable, or a keysym
 -- otherwise.
 -- @treturn boolean `true` if the event has been handled and should not be
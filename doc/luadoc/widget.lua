@@ -179,6 +179,27 @@
 -- @tparam string keystring The string representing the keys to send.
 -- @tparam table modifiers The key modifiers table.
 
+--- @method on_next_frame
+-- Call a function once, before the next frame of the widget is drawn. If the
+-- widget isn't visible, the function is called once it is first drawn, or
+-- not at all if the widget is destroyed first.
+-- @tparam function func The function to call.
+
+--- @method set_native_binds
+-- Set the key binds handled by the widget itself. When a key is pressed
+-- that matches one of these binds, its function is called with the widget,
+-- and the `key-press` signal is only emitted if the function returns `false`.
+-- This avoids creating the modifiers table and key name for each key press.
+--
+-- Binds use the normalized syntax of `lousy.bind`, such as `"<j>"` or
+-- `"<control-Down>"`. Binds that can't be matched natively are ignored.
+-- Key events with caps lock on always emit the `key-press` signal, as do
+-- synthetic key events unless `synthetic` is `true`.
+-- @tparam table binds A table mapping binds to functions, or `nil` to remove
+-- all native binds.
+-- @tparam[opt] boolean synthetic Whether synthetic key events, such as those
+-- sent with `send_key()`, are also matched.
+
 --- @signal create
 -- Emitted on the `widget` library when a new widget has been created.
 -- @tparam widget widget The newly-created widget.
@@ -20,7 +20,8 @@
 
 --- @property scroll
 -- The current scroll position. Two fields, `h` and `v`, specify the scroll
--- offset from the left and top respectively, in pixels.
+-- offset from the left and top respectively, in pixels. The
+-- `property::scroll` signal is emitted whenever the scroll position changes.
 -- @type table
 -- @readwrite
 
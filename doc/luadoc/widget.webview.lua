@@ -11,6 +11,21 @@
 -- 	print(type(view)) -- Prints "widget"
 -- 	print(view.type)  -- Prints "webview"
 --
+-- # Placeholder webviews
+--
+-- Creating a WebKit view is relatively expensive. A webview created with
+-- `placeholder = true` only creates it when the webview is first shown, or
+-- when a method or property that needs it is used:
+--
+--     local view = widget{ type = "webview", placeholder = true }
+--
+-- Until then, setting `uri` or `session_state` only records the location to
+-- load, and `session_state` returns the recorded state. If a session state
+-- has been set, setting `uri` only changes the displayed URI; it is loaded
+-- only if the session state has no current page.
+--
+-- A hidden webview can be turned back into a placeholder with `discard()`.
+--
 -- # Destroying a webview widget
 --
 --     view:destroy()
@@ -25,6 +40,19 @@
 -- @type boolean
 -- @readonly
 
+--- @property placeholder
+-- Whether the webview is a placeholder that has not yet created its WebKit
+-- view, or whose WebKit view was discarded.
+-- @type boolean
+-- @readonly
+
+--- @property title
+-- The title of the current page. The title of a placeholder can be set, for
+-- example to the title of a restored tab; it is shown until the page is
+-- loaded.
+-- @type string
+-- @readwrite
+
 --- @method search
 -- Begin searching the contents of the webview.
 --
@@ -84,8 +112,29 @@
 -- * `source` : A string to be used in error messages.
 -- * `no_return` : A boolean; if `false`, no result _or error_ will be returned.
 -- * `callback` : A callback function.
+-- * `args` : An array of arguments; only used when calling a registered script.
+-- * `format` : How the result is returned: `"lua"` (the default) converts it
+--   into a Lua value, `"json"` returns it serialized as a JSON string, and
+--   `"binary"` returns the contents of a string, `ArrayBuffer` or byte array
+--   as a Lua string. The latter two avoid building intermediate Lua tables for
+--   results that are only stored or forwarded.
+--
+-- Calls made to the same webview during one main loop iteration are sent to
+-- the web process together; callbacks are still called in order.
+--
+-- # Registered scripts
+--
+-- Instead of a string, `script` may be a handle returned by
+-- `luakit.register_js()`. The script is then compiled once per page and
+-- called as a function, with the values in `args` as its arguments:
+--
+--     local handle = luakit.register_js("return document.title + suffix", { args = { "suffix" } })
+--     view:eval_js(handle, { args = { " - luakit" }, callback = function (ret)
+--         msg.info("%s", ret)
+--     end })
 --
--- @tparam string script The JavaScript string to evaluate.
+-- @tparam string|number script The JavaScript string to evaluate, or a
+-- registered script handle.
 -- @tparam table options Additional arguments.
 
 --- @method load_string
@@ -132,6 +181,22 @@
 --- @method allow_certificate
 -- Allow a certificate.
 
+--- @method discard
+-- Destroy the WebKit view of a webview that is not shown, turning it into a
+-- placeholder. Its session state and title are kept, and it is reloaded when
+-- it is next shown or used.
+--
+-- @treturn boolean `true` if the webview was discarded, or `false` if it is
+-- shown or already a placeholder.
+
+--- @method set_settings
+-- Set several webview properties at once. Only properties whose value differs
+-- from the current value are set, and `property::*` signals are emitted after
+-- all properties have been updated.
+--
+-- @tparam table properties A table of property values, keyed by property name.
+-- @treturn integer The number of properties that were changed.
+
 --- @property uri
 -- The URI of the current web page.
 -- @type string
@@ -238,7 +303,8 @@
 -- Emitted when a mouse button was pressed with the cursor inside the `webview` widget.
 --
 -- @tparam table modifiers An array of strings, one for each modifier key held
--- at the time of the event.
+-- at the time of the event. The table is shared between events and must not
+-- be modified.
 -- @tparam integer button The number of the button pressed, beginning
 -- from `1`; i.e. `1` corresponds to the left mouse button.
 -- @tparam table hit_test A table representing the type of element under the
@@ -250,7 +316,8 @@
 -- Emitted when a mouse button was released with the cursor inside the `webview` widget.
 --
 -- @tparam table modifiers An array of strings, one for each modifier key held
--- at the time of the event.
+-- at the time of the event. The table is shared between events and must not
+-- be modified.
 -- @tparam integer button The number of the button pressed, beginning
 -- from `1`; i.e. `1` corresponds to the left mouse button.
 -- @tparam table hit_test A table representing the type of element under the
@@ -262,7 +329,8 @@
 -- Emitted when a mouse button was double-clicked with the cursor inside the `webview` widget.
 --
 -- @tparam table modifiers An array of strings, one for each modifier key held
--- at the time of the event.
+-- at the time of the event. The table is shared between events and must not
+-- be modified.
 -- @tparam integer button The number of the button pressed, beginning
 -- from `1`; i.e. `1` corresponds to the left mouse button.
 -- @tparam table hit_test A table representing the type of element under the
@@ -273,12 +341,14 @@
 --- @signal mouse-enter
 -- Emitted when the mouse cursor enters the `webview` widget.
 -- @tparam table modifiers An array of strings, one for each modifier key held.
+-- The table is shared between events and must not be modified.
 -- @treturn boolean `true` if the event has been handled and should not be
 -- propagated further.
 
 --- @signal mouse-leave
 -- Emitted when the mouse cursor leaves the `webview` widget.
 -- @tparam table modifiers An array of strings, one for each modifier key held.
+-- The table is shared between events and must not be modified.
 -- @treturn boolean `true` if the event has been handled and should not be
 -- propagated further.
 
@@ -356,6 +426,7 @@
 -- Emitted when a key is pressed while the `webview` widget has the
 -- input focus.
 -- @tparam table modifiers An array of strings, one for each modifier key held.
+-- The table is shared between events and must not be modified.
 -- @tparam string key The key that was pressed, if printable, or a keysym
 -- otherwise.
 -- @treturn boolean `true` if the event has been handled and should not be
@@ -41,21 +41,63 @@ luaH_check_page(lua_State *L, gint udx)
     return page;
 }
 
-static gboolean
-send_request_cb(WebKitWebPage *web_page, WebKitURIRequest *request,
-        WebKitURIResponse *UNUSED(redirected_response), page_t *UNUSED(page))
+#define HEADERS_MT "luakit.page.headers"
+
+/* Lazy proxy over the HTTP headers of a request; handlers that never touch
+ * the headers object cost a single small userdata allocation, and only the
+ * headers that are assigned to are ever modified */
+typedef struct _request_headers_t {
+    SoupMessageHeaders *hdrs;
+    gboolean valid;
+} request_headers_t;
+
+static request_headers_t *
+luaH_check_request_headers(lua_State *L, gint udx)
 {
-    lua_State *L = common.L;
-    const gchar *uri = webkit_uri_request_get_uri(request);
-    SoupMessageHeaders *hdrs = webkit_uri_request_get_http_headers(request);
+    request_headers_t *h = luaL_checkudata(L, udx, HEADERS_MT);
+    if (!h->valid)
+        luaL_error(L, "headers object is only valid during send-request");
+    return h;
+}
 
-    int top = lua_gettop(L);
+static gint
+luaH_request_headers_index(lua_State *L)
+{
+    request_headers_t *h = luaH_check_request_headers(L, 1);
+    const gchar *name = luaL_checkstring(L, 2);
+    const gchar *value = h->hdrs ? soup_message_headers_get_one(h->hdrs, name) : NULL;
+    if (!value)
+        return 0;
+    lua_pushstring(L, value);
+    return 1;
+}
+
+static gint
+luaH_request_headers_newindex(lua_State *L)
+{
+    request_headers_t *h = luaH_check_request_headers(L, 1);
+    const gchar *name = luaL_checkstring(L, 2);
+    if (!lua_isnil(L, 3))
+        luaL_checkstring(L, 3);
+    if (!h->hdrs)
+        return 0;
+
+    if (lua_isnil(L, 3))
+        soup_message_headers_remove(h->hdrs, name);
+    else
+        soup_message_headers_replace(h->hdrs, name, lua_tostring(L, 3));
+    return 0;
+}
 
-    /* Build headers table */
+/* Calling the headers object returns a plain table copy of all headers */
+static gint
+luaH_request_headers_call(lua_State *L)
+{
+    request_headers_t *h = luaH_check_request_headers(L, 1);
     lua_newtable(L);
-    if (hdrs) {
+    if (h->hdrs) {
         SoupMessageHeadersIter iter;
-        soup_message_headers_iter_init(&iter, hdrs);
+        soup_message_headers_iter_init(&iter, h->hdrs);
         const char *name, *value;
         while (soup_message_headers_iter_next(&iter, &name, &value)) {
             lua_pushstring(L, name);
@@ -63,12 +105,328 @@ send_request_cb(WebKitWebPage *web_page, WebKitURIRequest *request,
             lua_rawset(L, -3);
         }
     }
+    return 1;
+}
+
+static void
+request_headers_setup(lua_State *L)
+{
+    static const struct luaL_Reg headers_meta[] =
+    {
+        { "__index", luaH_request_headers_index },
+        { "__newindex", luaH_request_headers_newindex },
+        { "__call", luaH_request_headers_call },
+        { NULL, NULL }
+    };
+
+    luaL_newmetatable(L, HEADERS_MT);
+    luaL_register(L, NULL, headers_meta);
+    lua_pop(L, 1);
+}
+
+/* Native pre-filters for the send-request signal. Each filter belongs to a
+ * send-request handler function; a handler with filters is only called for
+ * requests that match at least one of them, and Lua is not entered at all
+ * if no handler is left. All criteria within a single filter must match. */
+typedef struct _request_filter_t {
+    gint id;
+    /** The handler function this filter gates */
+    gpointer handler;
+    gchar **schemes;
+    gchar **domains;
+    gchar **headers;
+    gboolean third_party;
+    GRegex *pattern;
+} request_filter_t;
+
+static GPtrArray *request_filters;
+static gint request_filter_next_id = 1;
+static struct {
+    guint64 emitted, skipped;
+} request_filter_stats;
+
+static void
+request_filter_free(request_filter_t *f)
+{
+    luaH_object_unref(common.L, f->handler);
+    g_strfreev(f->schemes);
+    g_strfreev(f->domains);
+    g_strfreev(f->headers);
+    if (f->pattern)
+        g_regex_unref(f->pattern);
+    g_slice_free(request_filter_t, f);
+}
+
+/* Find the host part of a URI without allocating */
+static const gchar *
+uri_host(const gchar *uri, gsize *len)
+{
+    const gchar *host = uri ? strstr(uri, "://") : NULL;
+    if (!host) {
+        *len = 0;
+        return NULL;
+    }
+    host += 3;
+    gsize n = strcspn(host, "/?#");
+    /* Strip userinfo */
+    const gchar *at = memchr(host, '@', n);
+    if (at) {
+        n -= at + 1 - host;
+        host = at + 1;
+    }
+    /* Strip port */
+    const gchar *colon = memchr(host, ':', n);
+    if (colon)
+        n = colon - host;
+    *len = n;
+    return host;
+}
+
+/* Whether host is equal to, or a subdomain of, domain */
+static gboolean
+host_has_suffix(const gchar *host, gsize hlen, const gchar *domain, gsize dlen)
+{
+    if (hlen < dlen)
+        return FALSE;
+    if (g_ascii_strncasecmp(host + hlen - dlen, domain, dlen))
+        return FALSE;
+    return hlen == dlen || host[hlen - dlen - 1] == '.';
+}
+
+static gboolean
+request_filter_match(request_filter_t *f, const gchar *uri,
+        const gchar *page_uri, SoupMessageHeaders *hdrs)
+{
+    if (f->schemes) {
+        gboolean found = FALSE;
+        for (gchar **scheme = f->schemes; *scheme && !found; scheme++) {
+            gsize n = strlen(*scheme);
+            found = !g_ascii_strncasecmp(uri, *scheme, n) && uri[n] == ':';
+        }
+        if (!found)
+            return FALSE;
+    }
+
+    gsize hlen;
+    const gchar *host = uri_host(uri, &hlen);
+
+    if (f->domains) {
+        gboolean found = FALSE;
+        for (gchar **domain = f->domains; *domain && !found; domain++)
+            found = host && host_has_suffix(host, hlen, *domain, strlen(*domain));
+        if (!found)
+            return FALSE;
+    }
+
+    if (f->third_party) {
+        gsize plen;
+        const gchar *page_host = uri_host(page_uri, &plen);
+        if (host && page_host && (host_has_suffix(host, hlen, page_host, plen)
+                    || host_has_suffix(page_host, plen, host, hlen)))
+            return FALSE;
+    }
+
+    if (f->headers) {
+        gboolean found = FALSE;
+        for (gchar **name = f->headers; *name && !found; name++)
+            found = hdrs && soup_message_headers_get_one(hdrs, *name);
+        if (!found)
+            return FALSE;
+    }
+
+    if (f->pattern && !g_regex_match(f->pattern, uri, 0, NULL))
+        return FALSE;
+
+    return TRUE;
+}
+
+/* The request a send-request emission is for */
+typedef struct {
+    const gchar *uri;
+    const gchar *page_uri;
+    SoupMessageHeaders *hdrs;
+} request_match_t;
+
+/* Whether a handler should be called for a request: either it has no
+ * filters, or one of its filters matches */
+static gboolean
+request_filters_match(gpointer handler, gpointer data)
+{
+    request_match_t *req = data;
+    gboolean filtered = FALSE;
+    for (guint i = 0; request_filters && i < request_filters->len; i++) {
+        request_filter_t *f = request_filters->pdata[i];
+        if (f->handler != handler)
+            continue;
+        if (request_filter_match(f, req->uri, req->page_uri, req->hdrs))
+            return TRUE;
+        filtered = TRUE;
+    }
+    return !filtered;
+}
+
+/* Check that field `name` of the table at idx is nil or an array of strings */
+static void
+luaH_request_filter_checkstrv(lua_State *L, gint idx, const gchar *name)
+{
+    lua_getfield(L, idx, name);
+    if (!lua_isnil(L, -1)) {
+        luaH_checktable(L, -1);
+        for (gint i = 1, len = lua_objlen(L, -1); i <= len; i++) {
+            lua_rawgeti(L, -1, i);
+            if (!lua_isstring(L, -1))
+                luaL_error(L, "request filter field '%s' must be an array of strings", name);
+            lua_pop(L, 1);
+        }
+    }
+    lua_pop(L, 1);
+}
+
+/* Read an optional array of strings from field `name` of the table at idx,
+ * which must have been checked with luaH_request_filter_checkstrv() */
+static gchar **
+luaH_request_filter_strv(lua_State *L, gint idx, const gchar *name)
+{
+    lua_getfield(L, idx, name);
+    if (lua_isnil(L, -1)) {
+        lua_pop(L, 1);
+        return NULL;
+    }
+    gint len = lua_objlen(L, -1);
+    gchar **strv = g_new0(gchar*, len + 1);
+    for (gint i = 0; i < len; i++) {
+        lua_rawgeti(L, -1, i + 1);
+        strv[i] = g_strdup(lua_tostring(L, -1));
+        lua_pop(L, 1);
+    }
+    lua_pop(L, 1);
+    return strv;
+}
+
+static gint
+luaH_page_add_request_filter(lua_State *L)
+{
+    luaH_checktable(L, 1);
+    luaH_checkfunction(L, 2);
+
+    /* Check all arguments before allocating anything, so that an error
+     * can't leak a partly built filter */
+    static const gchar *strv_fields[] = { "patterns", "schemes", "domains", "headers" };
+    for (guint i = 0; i < G_N_ELEMENTS(strv_fields); i++)
+        luaH_request_filter_checkstrv(L, 1, strv_fields[i]);
+
+    /* Compile all patterns into a single alternation */
+    GRegex *pattern = NULL;
+    gchar **patterns = luaH_request_filter_strv(L, 1, "patterns");
+    if (patterns && *patterns) {
+        GString *alt = g_string_new(NULL);
+        for (gchar **p = patterns; *p; p++)
+            g_string_append_printf(alt, "%s(?:%s)", p == patterns ? "" : "|", *p);
+        GError *error = NULL;
+        pattern = g_regex_new(alt->str, 0, 0, &error);
+        g_string_free(alt, TRUE);
+        if (error) {
+            lua_pushstring(L, error->message);
+            g_error_free(error);
+            g_strfreev(patterns);
+            return luaL_error(L, "invalid request filter pattern: %s", lua_tostring(L, -1));
+        }
+    }
+    g_strfreev(patterns);
+
+    request_filter_t *f = g_slice_new0(request_filter_t);
+    f->pattern = pattern;
+    f->schemes = luaH_request_filter_strv(L, 1, "schemes");
+    f->domains = luaH_request_filter_strv(L, 1, "domains");
+    f->headers = luaH_request_filter_strv(L, 1, "headers");
+    if (luaH_rawfield(L, 1, "third_party")) {
+        f->third_party = lua_toboolean(L, -1);
+        lua_pop(L, 1);
+    }
+    f->id = request_filter_next_id++;
+    f->handler = luaH_object_ref(L, 2);
+
+    if (!request_filters)
+        request_filters = g_ptr_array_new_with_free_func(
+                (GDestroyNotify)request_filter_free);
+    g_ptr_array_add(request_filters, f);
+
+    lua_pushinteger(L, f->id);
+    return 1;
+}
+
+static gint
+luaH_page_remove_request_filter(lua_State *L)
+{
+    gint id = luaL_checkinteger(L, 1);
+    for (guint i = 0; request_filters && i < request_filters->len; i++) {
+        request_filter_t *f = request_filters->pdata[i];
+        if (f->id == id) {
+            g_ptr_array_remove_index(request_filters, i);
+            lua_pushboolean(L, TRUE);
+            return 1;
+        }
+    }
+    lua_pushboolean(L, FALSE);
+    return 1;
+}
+
+static gint
+luaH_page_request_filter_stats(lua_State *L)
+{
+    lua_createtable(L, 0, 3);
+    lua_pushinteger(L, request_filters ? request_filters->len : 0);
+    lua_setfield(L, -2, "filters");
+    lua_pushnumber(L, request_filter_stats.emitted);
+    lua_setfield(L, -2, "emitted");
+    lua_pushnumber(L, request_filter_stats.skipped);
+    lua_setfield(L, -2, "skipped");
+    return 1;
+}
+
+static gboolean
+send_request_cb(WebKitWebPage *web_page, WebKitURIRequest *request,
+        WebKitURIResponse *UNUSED(redirected_response), page_t *page)
+{
+    lua_State *L = common.L;
+    const gchar *uri = webkit_uri_request_get_uri(request);
+    SoupMessageHeaders *hdrs = webkit_uri_request_get_http_headers(request);
+
+    /* Don't enter Lua, or allocate anything, unless some handler is
+     * interested */
+    signal_array_t *sigfuncs = signal_lookup(page->signals, "send-request");
+    request_match_t req = {
+        .uri = uri,
+        .page_uri = webkit_web_page_get_uri(web_page),
+        .hdrs = hdrs,
+    };
+    gboolean interested = FALSE;
+    for (guint i = 0; sigfuncs && i < sigfuncs->len && !interested; i++)
+        interested = request_filters_match(sigfuncs->pdata[i], &req);
+    if (!interested) {
+        request_filter_stats.skipped++;
+        return FALSE;
+    }
+    request_filter_stats.emitted++;
+
+    int top = lua_gettop(L);
+
+    /* Build headers proxy; nothing is copied until a handler asks for it */
+    request_headers_t *h = lua_newuserdata(L, sizeof(*h));
+    h->hdrs = hdrs;
+    h->valid = TRUE;
+    luaL_getmetatable(L, HEADERS_MT);
+    lua_setmetatable(L, -2);
+    gint headers_idx = lua_gettop(L);
 
     luaH_page_from_web_page(L, web_page);
     lua_pushstring(L, uri);
-    lua_pushvalue(L, -3);
+    lua_pushvalue(L, headers_idx);
+    gint ret = luaH_object_emit_signal_filtered(L, -3, "send-request", 2, 1,
+            request_filters_match, &req);
 
-    gint ret = luaH_object_emit_signal(L, -3, "send-request", 2, 1);
+    /* Handlers may keep a reference; make sure it can't outlive the request */
+    h->valid = FALSE;
 
     if (ret) {
         /* First argument: redirect url or false to block */
@@ -81,31 +439,6 @@ send_request_cb(WebKitWebPage *web_page, WebKitURIRequest *request,
             lua_settop(L, top);
             return TRUE;
         }
-        lua_pop(L, ret);
-    }
-
-    lua_pop(L, 1);
-
-    /* Rebuild HTTP headers from headers table */
-    if (hdrs) {
-        /* Update all values */
-        lua_pushnil(L);
-        while (lua_next(L, -2)) {
-            soup_message_headers_replace(hdrs, luaL_checkstring(L, -2), luaL_checkstring(L, -1));
-            lua_pop(L, 1);
-        }
-
-        /* Remove table values that were removed */
-        SoupMessageHeadersIter iter;
-        soup_message_headers_iter_init(&iter, hdrs);
-        const char *name, *value;
-        while (soup_message_headers_iter_next(&iter, &name, &value)) {
-            lua_pushstring(L, name);
-            lua_rawget(L, -2);
-            if (lua_isnil(L, -1))
-                soup_message_headers_remove(hdrs, name);
-            lua_pop(L, 1);
-        }
     }
 
     lua_settop(L, top);
@@ -141,7 +474,7 @@ luaH_page_eval_js(lua_State *L)
     WebKitFrame *frame = webkit_web_page_get_main_frame(page->page);
     WebKitScriptWorld *world = extension.script_world;
     JSGlobalContextRef ctx = webkit_frame_get_javascript_context_for_script_world(frame, world);
-    return luaJS_eval_js(common.L, ctx, script, source, false);
+    return luaJS_eval_js(common.L, ctx, script, source, false, LUAJS_RESULT_LUA);
 }
 
 static gint
@@ -289,6 +622,9 @@ page_class_setup(lua_State *L)
     {
         LUA_CLASS_METHODS(page)
         { "__call", luaH_page_new },
+        { "add_request_filter", luaH_page_add_request_filter },
+        { "remove_request_filter", luaH_page_remove_request_filter },
+        { "request_filter_stats", luaH_page_request_filter_stats },
         { NULL, NULL }
     };
 
@@ -306,6 +642,7 @@ page_class_setup(lua_State *L)
             page_methods, page_meta);
 
     luaH_uniq_setup(L, REG_KEY, "");
+    request_headers_setup(L);
 }
 
 // vim: ft=c:et:sw=4:ts=8:sts=4:tw=80
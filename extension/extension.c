@@ -23,6 +23,8 @@
 #include "common/util.h"
 #include "common/luah.h"
 #include "common/luautil.h"
+#include "common/luacache.h"
+#include "common/trace.h"
 #include "common/luauniq.h"
 #include "extension/ipc.h"
 #include "common/luaobject.h"
@@ -54,7 +56,7 @@ extension_t extension;
 
 
 static void
-web_lua_init(const char *package_path, const char *package_cpath)
+web_lua_init(const char *package_path, const char *package_cpath, const char *cache_dir)
 {
     debug("Lua initializing...");
 
@@ -74,6 +76,8 @@ web_lua_init(const char *package_path, const char *package_cpath)
     lua_pushstring(L, package_cpath);
     lua_setfield(L, -2, "cpath");
     lua_pop(L, 1);
+    luaH_bytecode_cache_setup(L, cache_dir, "bytecode-web");
+    luaH_trace_setup(L);
 
     luakit_lib_setup(L);
     soup_lib_setup(L);
@@ -92,8 +96,13 @@ web_lua_init(const char *package_path, const char *package_cpath)
 G_MODULE_EXPORT void
 webkit_web_extension_initialize_with_user_data(WebKitWebExtension *ext, GVariant *payload)
 {
-    gchar *socket_path, *package_path, *package_cpath;
-    g_variant_get(payload, "(sss)", &socket_path, &package_path, &package_cpath);
+    gchar *socket_path, *package_path, *package_cpath, *cache_dir;
+    gboolean trace;
+    g_variant_get(payload, "(ssssb)", &socket_path, &package_path, &package_cpath, &cache_dir, &trace);
+
+    gint64 start = trace_now();
+    if (trace)
+        trace_init("luakit web process", NULL, 0);
 
     common.L = luaL_newstate();
     common.L = common.L;
@@ -105,13 +114,14 @@ webkit_web_extension_initialize_with_user_data(WebKitWebExtension *ext, GVariant
         exit(EXIT_FAILURE);
     }
 
-    web_lua_init(package_path, package_cpath);
+    web_lua_init(package_path, package_cpath, cache_dir);
     web_scroll_init();
     web_luajs_init();
     web_script_world_init();
 
     debug("PID %d", getpid());
     debug("ready for messages");
+    trace_span("startup", "web extension init", start);
 
     ipc_header_t header = { .type = IPC_TYPE_extension_init, .length = 0 };
     ipc_send(extension.ipc, &header, NULL);
@@ -27,16 +27,19 @@
 #include "extension/extension.h"
 #include "extension/clib/luakit.h"
 #include "extension/ipc.h"
+#include "extension/luajs.h"
 #include "extension/scroll.h"
 #include "common/util.h"
 #include "common/luajs.h"
 #include "common/luaserialize.h"
 #include "common/clib/ipc.h"
+#include "common/trace.h"
 
 static GPtrArray *queued_page_ipc;
 
 IPC_NO_HANDLER(page_created)
 IPC_NO_HANDLER(log)
+IPC_NO_HANDLER(trace)
 
 void
 ipc_recv_lua_require_module(ipc_endpoint_t *UNUSED(ipc), const ipc_lua_require_module_t *msg, guint length)
@@ -57,10 +60,19 @@ ipc_recv_lua_ipc(ipc_endpoint_t *UNUSED(ipc), const ipc_lua_ipc_t *msg, guint le
 }
 
 void
-ipc_recv_extension_init(ipc_endpoint_t *UNUSED(ipc), gpointer UNUSED(msg), guint UNUSED(length))
+ipc_recv_extension_init(ipc_endpoint_t *ipc, gpointer UNUSED(msg), guint UNUSED(length))
 {
     emit_pending_page_creation_ipc();
     luakit_lib_emit_pending_signals(common.L);
+
+    /* Web modules have now been loaded; send the startup trace */
+    gchar *events = trace_take_events();
+    if (events) {
+        ipc_header_t header = { .type = IPC_TYPE_trace, .length = strlen(events) };
+        ipc_send(ipc, &header, events);
+        g_free(events);
+    }
+    trace_finish();
 }
 
 void
@@ -79,34 +91,71 @@ ipc_recv_scroll(ipc_endpoint_t *UNUSED(ipc), const guint8 *msg, guint length)
     lua_pop(L, 3);
 }
 
-void
-ipc_recv_eval_js(ipc_endpoint_t *UNUSED(ipc), const guint8 *msg, guint length)
+static luajs_result_format_t
+eval_js_result_format(const gchar *format)
 {
-    lua_State *L = common.L;
-    gint top = lua_gettop(L);
-    gint n = lua_deserialize_range(L, msg, length);
-    g_assert_cmpint(n, ==, 5);
+    if (!g_strcmp0(format, "json"))
+        return LUAJS_RESULT_JSON;
+    if (!g_strcmp0(format, "binary"))
+        return LUAJS_RESULT_BINARY;
+    return LUAJS_RESULT_LUA;
+}
 
-    gboolean no_return = lua_toboolean(L, -5);
-    const gchar *script = lua_tostring(L, -4);
-    const gchar *source = lua_tostring(L, -3);
+/* Run one eval_js request at the top of the stack, and append its reply to
+ * the batch being built */
+static void
+eval_js_one(lua_State *L, GByteArray *reply)
+{
+    gboolean no_return = lua_toboolean(L, -7);
+    /* script or registered script handle is index -6 */
+    const gchar *source = lua_tostring(L, -5);
+    /* args table (registered scripts only) is index -4 */
+    luajs_result_format_t format = eval_js_result_format(lua_tostring(L, -3));
     guint64 page_id = lua_tointeger(L, -2);
     /* cb ref is index -1 */
 
+    gint n = 0;
     WebKitWebPage *page = webkit_web_extension_get_page(extension.ext, page_id);
     if (!page) {
         /* Notify UI to free callback ref */
-        ipc_send_lua(extension.ipc, IPC_TYPE_eval_js, L, -2, -1);
-        lua_settop(L, top);
-        return;
+    } else if (lua_type(L, -6) == LUA_TNUMBER) {
+        gint args_idx = lua_istable(L, -4) ? luaH_absindex(L, -4) : 0;
+        n = luaJS_eval_registered(L, page, lua_tointeger(L, -6), args_idx, no_return, format);
+    } else {
+        WebKitFrame *frame = webkit_web_page_get_main_frame(page);
+        WebKitScriptWorld *world = webkit_script_world_get_default();
+        JSGlobalContextRef ctx = webkit_frame_get_javascript_context_for_script_world(frame, world);
+        n = luaJS_eval_js(L, ctx, lua_tostring(L, -6), source, no_return, format);
+    }
+
+    /* Append [page_id, cb, n, ret] or [page_id, cb, n, nil, error] */
+    lua_pushinteger(L, n);
+    lua_insert(L, -n-1);
+    lua_serialize_range(L, reply, -n-3, -1);
+}
+
+void
+ipc_recv_eval_js(ipc_endpoint_t *UNUSED(ipc), const guint8 *msg, guint length)
+{
+    lua_State *L = common.L;
+    gint top = lua_gettop(L);
+    gint n = lua_deserialize_range(L, msg, length);
+    g_assert_cmpint(n % 7, ==, 0);
+
+    /* A batch of requests, each
+     * [no_return, script or handle, source, args, format, page_id, cb] */
+    GByteArray *reply = g_byte_array_new();
+    for (gint i = 0; i < n; i += 7) {
+        gint base = lua_gettop(L);
+        for (gint j = 1; j <= 7; j++)
+            lua_pushvalue(L, top + i + j);
+        eval_js_one(L, reply);
+        lua_settop(L, base);
     }
 
-    WebKitFrame *frame = webkit_web_page_get_main_frame(page);
-    WebKitScriptWorld *world = webkit_script_world_get_default();
-    JSGlobalContextRef ctx = webkit_frame_get_javascript_context_for_script_world(frame, world);
-    n = luaJS_eval_js(L, ctx, script, source, no_return);
-    /* Send [page_id, cb, ret] or [page_id, cb, nil, error] */
-    ipc_send_lua(extension.ipc, IPC_TYPE_eval_js, L, -n-2, -1);
+    ipc_header_t header = { .type = IPC_TYPE_eval_js, .length = reply->len };
+    ipc_send(extension.ipc, &header, reply->data);
+    g_byte_array_unref(reply);
     lua_settop(L, top);
 }
 
@@ -203,12 +203,193 @@ static void register_func(WebKitScriptWorld *world, WebKitWebPage *web_page, Web
     JSStringRelease(js_name);
 }
 
+/* Scripts registered by the UI process with luakit.register_js() */
+typedef struct _registered_js_t {
+    JSStringRef body;
+    JSStringRef source;
+    gchar *source_name;
+    guint argc;
+    JSStringRef *argv;
+} registered_js_t;
+
+static GHashTable *registered_js;
+
+/* Per-page cache of compiled registered scripts; only valid for the global
+ * context they were compiled in, and cleared whenever that changes */
+typedef struct _compiled_js_cache_t {
+    JSGlobalContextRef context;
+    GHashTable *funcs;
+} compiled_js_cache_t;
+
+#define COMPILED_JS_CACHE_KEY "luakit-compiled-js-cache"
+
+static void
+registered_js_free(registered_js_t *js)
+{
+    JSStringRelease(js->body);
+    JSStringRelease(js->source);
+    g_free(js->source_name);
+    for (guint i = 0; i < js->argc; i++)
+        JSStringRelease(js->argv[i]);
+    g_free(js->argv);
+    g_slice_free(registered_js_t, js);
+}
+
+static void
+compiled_js_cache_clear(compiled_js_cache_t *cache)
+{
+    if (!cache->context)
+        return;
+    GHashTableIter iter;
+    gpointer func;
+    g_hash_table_iter_init(&iter, cache->funcs);
+    while (g_hash_table_iter_next(&iter, NULL, &func))
+        JSValueUnprotect(cache->context, func);
+    g_hash_table_remove_all(cache->funcs);
+    JSGlobalContextRelease(cache->context);
+    cache->context = NULL;
+}
+
+static void
+compiled_js_cache_free(compiled_js_cache_t *cache)
+{
+    compiled_js_cache_clear(cache);
+    g_hash_table_destroy(cache->funcs);
+    g_slice_free(compiled_js_cache_t, cache);
+}
+
+void
+ipc_recv_js_register(ipc_endpoint_t *UNUSED(ipc), const guint8 *msg, guint length)
+{
+    lua_State *L = common.L;
+    gint top = lua_gettop(L);
+    gint n = lua_deserialize_range(L, msg, length);
+
+    if (!registered_js)
+        registered_js = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                NULL, (GDestroyNotify)registered_js_free);
+
+    /* [id] unregisters, [id, script, source, argument names] registers */
+    gint id = lua_tointeger(L, top + 1);
+    if (n == 1) {
+        g_hash_table_remove(registered_js, GINT_TO_POINTER(id));
+        lua_settop(L, top);
+        return;
+    }
+    g_assert_cmpint(n, ==, 4);
+
+    registered_js_t *js = g_slice_new0(registered_js_t);
+    js->body = JSStringCreateWithUTF8CString(lua_tostring(L, top + 2));
+    js->source_name = g_strdup(lua_tostring(L, top + 3));
+    js->source = JSStringCreateWithUTF8CString(js->source_name);
+    js->argc = lua_objlen(L, top + 4);
+    js->argv = g_new0(JSStringRef, js->argc);
+    for (guint i = 0; i < js->argc; i++) {
+        lua_rawgeti(L, top + 4, i + 1);
+        js->argv[i] = JSStringCreateWithUTF8CString(lua_tostring(L, -1) ?: "");
+        lua_pop(L, 1);
+    }
+    g_hash_table_insert(registered_js, GINT_TO_POINTER(id), js);
+
+    lua_settop(L, top);
+}
+
+static gint
+luaJS_push_exception(lua_State *L, JSContextRef context, const gchar *source, JSValueRef exception)
+{
+    lua_pushnil(L);
+    lua_pushstring(L, source);
+    lua_pushstring(L, ": ");
+    if (!luaJS_pushstring(L, context, exception, NULL))
+        lua_pushliteral(L, "Unknown JavaScript exception (unable to "
+                "convert thrown exception object into string)");
+    lua_concat(L, 3);
+    return 2;
+}
+
+/* Call a registered script in the default script world of a page, compiling
+ * it first if necessary. Pushes results the same way as luaJS_eval_js(). */
+gint
+luaJS_eval_registered(lua_State *L, WebKitWebPage *page, gint id, gint args_idx, bool no_return, luajs_result_format_t format)
+{
+    registered_js_t *js = registered_js ? g_hash_table_lookup(registered_js, GINT_TO_POINTER(id)) : NULL;
+    if (!js) {
+        lua_pushnil(L);
+        lua_pushfstring(L, "unknown registered script handle %d", id);
+        return 2;
+    }
+
+    WebKitFrame *frame = webkit_web_page_get_main_frame(page);
+    WebKitScriptWorld *world = webkit_script_world_get_default();
+    JSGlobalContextRef context = webkit_frame_get_javascript_context_for_script_world(frame, world);
+
+    compiled_js_cache_t *cache = g_object_get_data(G_OBJECT(page), COMPILED_JS_CACHE_KEY);
+    if (!cache) {
+        cache = g_slice_new0(compiled_js_cache_t);
+        cache->funcs = g_hash_table_new(g_direct_hash, g_direct_equal);
+        g_object_set_data_full(G_OBJECT(page), COMPILED_JS_CACHE_KEY, cache,
+                (GDestroyNotify)compiled_js_cache_free);
+    }
+    if (cache->context != context) {
+        compiled_js_cache_clear(cache);
+        cache->context = JSGlobalContextRetain(context);
+    }
+
+    JSValueRef exception = NULL;
+    JSObjectRef func = g_hash_table_lookup(cache->funcs, GINT_TO_POINTER(id));
+    if (!func) {
+        func = JSObjectMakeFunction(context, NULL, js->argc, js->argv,
+                js->body, js->source, 1, &exception);
+        if (exception)
+            return luaJS_push_exception(L, context, js->source_name, exception);
+        JSValueProtect(context, func);
+        g_hash_table_insert(cache->funcs, GINT_TO_POINTER(id), func);
+    }
+
+    /* Convert arguments */
+    gint argc = args_idx ? lua_objlen(L, args_idx) : 0;
+    JSValueRef *argv = argc > 0 ? g_alloca(sizeof(*argv)*argc) : NULL;
+    for (gint i = 0; i < argc; i++) {
+        gchar *error = NULL;
+        lua_rawgeti(L, args_idx, i + 1);
+        argv[i] = luaJS_tovalue(L, context, -1, &error);
+        lua_pop(L, 1);
+        if (error) {
+            lua_pushnil(L);
+            lua_pushfstring(L, "bad argument #%d to registered script (%s)", i + 1, error);
+            g_free(error);
+            return 2;
+        }
+    }
+
+    JSValueRef result = JSObjectCallAsFunction(context, func, NULL, argc, argv, &exception);
+    if (exception)
+        return luaJS_push_exception(L, context, js->source_name, exception);
+
+    if (no_return)
+        return 0;
+
+    gchar *error = NULL;
+    if (luaJS_pushresult(L, context, result, format, &error))
+        return 1;
+
+    lua_pushnil(L);
+    lua_pushstring(L, error);
+    g_free(error);
+    return 2;
+}
+
 static void
 window_object_cleared_cb(WebKitScriptWorld *world, WebKitWebPage *web_page, WebKitFrame *frame, gpointer UNUSED(user_data))
 {
     if (!webkit_frame_is_main_frame(frame))
         return;
 
+    /* Release scripts compiled for the previous global object */
+    compiled_js_cache_t *cache = g_object_get_data(G_OBJECT(web_page), COMPILED_JS_CACHE_KEY);
+    if (cache)
+        compiled_js_cache_clear(cache);
+
     lua_State *L = common.L;
     const gchar *uri = webkit_web_page_get_uri(web_page) ?: "about:blank";
 
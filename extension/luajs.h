@@ -21,10 +21,14 @@
 
 #include <glib.h>
 
+#include "common/luajs.h"
+
 void web_luajs_init(void);
 void luaJS_register_function(lua_State *L);
 void ipc_recv_lua_js_call(ipc_endpoint_t *from, const guint8 *msg, guint length);
 void ipc_recv_lua_js_register(ipc_endpoint_t *from, const guint8 *msg, guint length);
+void ipc_recv_js_register(ipc_endpoint_t *from, const guint8 *msg, guint length);
+gint luaJS_eval_registered(lua_State *L, WebKitWebPage *page, gint id, gint args_idx, bool no_return, luajs_result_format_t format);
 
 #endif
 
@@ -56,6 +56,8 @@ typedef struct {
     gboolean nounique;
     /** Arguments provided to luakit */
     GPtrArray *argv;
+    /** File to write a startup trace to, if given */
+    gchar *trace_path;
 
     /** Pointer array to all active window userdata objects. */
     GPtrArray *windows;
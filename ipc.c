@@ -33,12 +33,14 @@
 #include "clib/luakit.h"
 #include "clib/widget.h"
 #include "common/luaserialize.h"
+#include "common/trace.h"
 #include "common/clib/ipc.h"
 #include "web_context.h"
 #include "widgets/webview.h"
 
-void webview_scroll_recv(void *d, const ipc_scroll_t *ipc);
+void webview_scroll_recv(widget_t *w, const ipc_scroll_t *ipc);
 void run_javascript_finished(const guint8 *msg, guint length);
+void webview_register_js_on_endpoint(ipc_endpoint_t *ipc);
 
 static char *socket_path;
 GMutex socket_path_lock;
@@ -47,11 +49,13 @@ GCond socket_path_cond;
 IPC_NO_HANDLER(lua_require_module)
 IPC_NO_HANDLER(web_extension_loaded)
 IPC_NO_HANDLER(crash)
+IPC_NO_HANDLER(js_register)
 
 void
 ipc_recv_extension_init(ipc_endpoint_t *ipc, const gpointer UNUSED(msg), guint UNUSED(length))
 {
     web_module_load_modules_on_endpoint(ipc);
+    webview_register_js_on_endpoint(ipc);
 
     /* Notify web extension that pending signals can be released */
     ipc_header_t header = { .type = IPC_TYPE_extension_init, .length = 0 };
@@ -67,7 +71,9 @@ ipc_recv_lua_ipc(ipc_endpoint_t *UNUSED(ipc), const ipc_lua_ipc_t *msg, guint le
 void
 ipc_recv_scroll(ipc_endpoint_t *UNUSED(ipc), ipc_scroll_t *msg, guint UNUSED(length))
 {
-    g_ptr_array_foreach(globalconf.webviews, (GFunc)webview_scroll_recv, msg);
+    widget_t *w = webview_get_by_id(msg->page_id);
+    if (w)
+        webview_scroll_recv(w, msg);
 }
 
 void
@@ -84,8 +90,16 @@ ipc_recv_page_created(ipc_endpoint_t *ipc, const ipc_page_created_t *msg, guint
     /* Page may already have been closed */
     if (!w) return;
 
-    webview_connect_to_endpoint(w, ipc);
+    /* Set the process ID first, so that it is known to the signals emitted
+     * on connection */
     webview_set_web_process_id(w, msg->pid);
+    webview_connect_to_endpoint(w, ipc);
+}
+
+void
+ipc_recv_trace(ipc_endpoint_t *UNUSED(ipc), const gchar *msg, guint length)
+{
+    trace_add_events(msg, length);
 }
 
 static gchar *
@@ -187,7 +201,8 @@ initialize_web_extensions_cb(WebKitWebContext *context, gpointer UNUSED(data))
     const char *package_cpath = lua_tostring(common.L, -1);
     lua_pop(common.L, 3);
 
-    GVariant *payload = g_variant_new("(sss)", path, package_path, package_cpath);
+    GVariant *payload = g_variant_new("(ssssb)", path, package_path, package_cpath,
+            globalconf.cache_dir, trace_enabled);
     webkit_web_context_set_web_extensions_initialization_user_data(context, payload);
     webkit_web_context_set_web_extensions_directory(context, dir);
 
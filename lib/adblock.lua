@@ -304,9 +304,7 @@ local function write_subscriptions(file)
     end
 
     -- Write table to disk
-    local fh = io.open(file, "w")
-    fh:write(table.concat(lines, "\n"))
-    io.close(fh)
+    luakit.save_file_async(file, table.concat(lines, "\n"))
 end
 
 -- Remove options and add new ones to list
@@ -371,6 +369,7 @@ end
 local function read_subscriptions(file)
     -- Find a subscriptions file
     if not file then file = subscriptions_file end
+    luakit.flush_file_writes(file)
     if not os.exists(file) then
         msg.info(string.format("subscriptions file '%s' doesn't exist", file))
         return
@@ -456,16 +455,16 @@ _M.whitelist_domain_access = function (domain)
     adblock_wm:emit_signal("update_page_whitelist", page_whitelist)
 end
 
-local new_web_extension_created
+-- Web process IDs of web extensions that have loaded the adblock rules
+local rules_loaded = {}
 
 webview.add_signal("init", function (view)
     webview.modify_load_block(view, "adblock", _M.enabled)
 
     view:add_signal("web-extension-loaded", function (v)
-        if not new_web_extension_created then
+        if rules_loaded[v.web_process_id] then
             webview.modify_load_block(v, "adblock", false)
         end
-        new_web_extension_created = nil
     end)
 
     -- if adblocking is disabled, unblock the tab as soon as it's switched to
@@ -478,6 +477,7 @@ webview.add_signal("init", function (view)
     view:add_signal("switched-page", unblock)
 end)
 adblock_wm:add_signal("rules_updated", function (_, web_process_id)
+    rules_loaded[web_process_id] = true
     for _, ww in pairs(window.bywidget) do
         for _, v in pairs(ww.tabs.children) do
             if v.web_process_id == web_process_id then
@@ -488,7 +488,8 @@ adblock_wm:add_signal("rules_updated", function (_, web_process_id)
 end)
 
 luakit.add_signal("web-extension-created", function (view)
-    new_web_extension_created = true
+    -- Process IDs may be reused by a new web process
+    rules_loaded[view.web_process_id] = nil
     adblock_wm:emit_signal(view, "update_rules", _M.rules)
     for name, list in pairs(_M.rules) do
         local enabled = util.table.hasitem(list.opts, "Enabled")
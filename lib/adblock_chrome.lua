@@ -25,6 +25,7 @@ local window     = require("window")
 local webview    = require("webview")
 local error_page = require("error_page")
 local modes      = require("modes")
+local tasks      = require("lousy.tasks")
 local add_binds, add_cmds = modes.add_binds, modes.add_cmds
 
 local _M = {}
@@ -152,15 +153,21 @@ _M.html_style = [===[
 ]===]
 
 -- Functions
--- Refresh open filters views (if any)
+-- Refresh open filters views (if any), a window at a time in the background
 local function refresh_views()
-    for _, w in pairs(window.bywidget) do
-        for _, v in ipairs(w.tabs.children) do
-            if string.match(v.uri or "", "^luakit://adblock/?") then
-                v:reload()
+    local wins = lousy.util.table.values(window.bywidget)
+    tasks.spawn(function ()
+        for _, w in ipairs(wins) do
+            if w.win then
+                for _, v in ipairs(w.tabs.children) do
+                    if string.match(v.uri or "", "^luakit://adblock/?") then
+                        v:reload()
+                    end
+                end
             end
+            tasks.yield()
         end
-    end
+    end)
 end
 
 adblock.refresh_views = refresh_views
@@ -12,7 +12,21 @@ local rules = {}
 local enabled_rules = {}
 local page_whitelist = {}
 
-ui:add_signal("enable", function(_, _, e) enabled = e end)
+local send_request
+
+-- Only network requests are filtered; skip everything else natively, and
+-- skip every request while adblocking is disabled
+local request_filter
+local function update_request_filter()
+    if request_filter then page.remove_request_filter(request_filter) end
+    local schemes = enabled and { "http", "https", "ws", "wss", "ftp" } or {}
+    request_filter = page.add_request_filter({ schemes = schemes }, send_request)
+end
+
+ui:add_signal("enable", function(_, _, e)
+    enabled = e
+    update_request_filter()
+end)
 ui:add_signal("update_rules", function(_, _, r)
     rules = r
     ui:emit_signal("rules_updated", luakit.web_process_id)
@@ -165,20 +179,23 @@ local filter = function (src, dst)
     end
 end
 
-luakit.add_signal("page-created", function(page)
-    page:add_signal("send-request", function(p, uri)
-        -- Prevent adblock-blocked: pages from being blocked themselves
-        if uri:match("^adblock%-blocked:") then return end
-
-        local allow = filter(p.uri, uri)
-        if allow == false and p.uri == uri then
-            if not lousy.util.table.hasitem(page_whitelist, lousy.uri.parse(uri).host) then
-                return "adblock-blocked:" .. uri
-            end
-        else
-            if allow == false then return false end
+send_request = function (p, uri)
+    -- Prevent adblock-blocked: pages from being blocked themselves
+    if uri:match("^adblock%-blocked:") then return end
+
+    local allow = filter(p.uri, uri)
+    if allow == false and p.uri == uri then
+        if not lousy.util.table.hasitem(page_whitelist, lousy.uri.parse(uri).host) then
+            return "adblock-blocked:" .. uri
         end
-    end)
+    else
+        if allow == false then return false end
+    end
+end
+update_request_filter()
+
+luakit.add_signal("page-created", function(page)
+    page:add_signal("send-request", send_request)
 end)
 
 -- vim: et:sw=4:ts=8:sts=4:tw=80
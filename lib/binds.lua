@@ -108,26 +108,32 @@ modes.add_binds("all", {
 local actions = { scroll = {
     up = {
         desc = "Scroll the current page up.",
+        native = true,
         func = function (w, m) w:scroll{ yrel = -settings.get_setting("window.scroll_step")*(m.count or 1) } end,
     },
     down = {
         desc = "Scroll the current page down.",
+        native = true,
         func = function (w, m) w:scroll{ yrel =  settings.get_setting("window.scroll_step")*(m.count or 1) } end,
     },
     left = {
         desc = "Scroll the current page left.",
+        native = true,
         func = function (w, m) w:scroll{ xrel = -settings.get_setting("window.scroll_step")*(m.count or 1) } end,
     },
     right = {
         desc = "Scroll the current page right.",
+        native = true,
         func = function (w, m) w:scroll{ xrel =  settings.get_setting("window.scroll_step")*(m.count or 1) } end,
     },
     page_up = {
         desc = "Scroll the current page up a full screen.",
+        native = true,
         func = function (w, m) w:scroll{ ypagerel = -(m.count or 1) } end,
     },
     page_down = {
         desc = "Scroll the current page down a full screen.",
+        native = true,
         func = function (w, m) w:scroll{ ypagerel =  (m.count or 1) } end,
     },
 }, zoom = {
@@ -151,7 +157,7 @@ local actions = { scroll = {
 modes.add_binds("normal", {
     -- Autoparse the `[count]` before a binding and re-call the hit function
     -- with the count removed and added to the opts table.
-    { "<any>", [[Meta-binding to detect the `^[count]` syntax. The `[count]` is parsed
+    { "<any>", { needs_buffer = true, desc = [[Meta-binding to detect the `^[count]` syntax. The `[count]` is parsed
         and stripped from the internal buffer string and the value assigned to
         `state.count`. Then `lousy.bind.hit()` is re-called with the modified
         buffer string & original modifier state.
@@ -170,7 +176,7 @@ modes.add_binds("normal", {
         (the bottom). All without the need to use `lousy.bind.buf` bindings
         everywhere and or using a `^(%d*)` pattern prefix on every binding which
         would like to make use of the `[count]` syntax.]],
-        function (w, m)
+        func = function (w, m)
             local count, buffer
             if m.buffer then
                 count = string.match(m.buffer, "^(%d+)")
@@ -184,7 +190,7 @@ modes.add_binds("normal", {
                 end
             end
             return false
-        end },
+        end } },
 
     { "i", "Enter `insert` mode.", function (w) w:set_mode("insert") end, {} },
     { ":", "Enter `command` mode.", function (w) w:set_mode("command") end, {} },
@@ -37,6 +37,11 @@ function _M.init()
             modified INTEGER
         );
     ]]
+
+    -- Mark bookmarks in the URL suggestion index
+    for _, row in ipairs(_M.db:exec [[ SELECT uri, title FROM bookmarks ]]) do
+        url_index.bookmark(row.uri, true, row.title)
+    end
 end
 
 luakit.idle_add(_M.init)
@@ -57,7 +62,13 @@ function _M.remove(id)
 
     _M.emit_signal("remove", id)
 
+    local b = _M.get(id)
     _M.db:exec([[ DELETE FROM bookmarks WHERE id = ? ]], { id })
+
+    -- The same URI may be bookmarked more than once
+    if b and not _M.db:exec([[ SELECT id FROM bookmarks WHERE uri = ? LIMIT 1 ]], { b.uri })[1] then
+        url_index.bookmark(b.uri, false)
+    end
 end
 
 local function parse_tags(tags)
@@ -137,6 +148,7 @@ function _M.add(uri, opts)
     })
 
     local id = _M.db:exec("SELECT last_insert_rowid() AS id")[1].id
+    url_index.bookmark(uri, true, opts.title)
     _M.emit_signal("add", id)
 
     -- Add bookmark tags
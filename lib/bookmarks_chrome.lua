@@ -18,7 +18,6 @@
 local bookmarks = require("bookmarks")
 local lousy = require("lousy")
 local chrome = require("chrome")
-local markdown = require("markdown")
 local modes = require("modes")
 local add_binds, add_cmds = modes.add_binds, modes.add_cmds
 
@@ -487,7 +486,7 @@ local export_funcs = {
 
         local rows = bookmarks.db:exec(sql, args)
 
-        local date = os.date
+        local date, markdown = os.date, require("markdown")
         for _, row in ipairs(rows) do
             row.date = date("%d %B %Y", row.created)
             local desc = row.desc
@@ -170,16 +170,30 @@ _M.stylesheet = [===[
 local handlers = {}
 local on_first_visual_handlers = {}
 local page_funcs = {}
+-- Modules providing lazily registered pages, which have not been loaded yet
+local lazy_modules = {}
 
 --- Retrieve a list of the currently registered luakit:// handlers.
 -- @treturn {string} A list of `luakit://` handler names, in alphabetical order.
 function _M.available_handlers()
-    return lousy.util.table.keys(handlers)
+    local pages = lousy.util.table.keys(handlers)
+    for page in pairs(lazy_modules) do
+        if not handlers[page] then table.insert(pages, page) end
+    end
+    table.sort(pages)
+    return pages
 end
 
 --- Register a chrome page URI with an associated handler function.
+--
+-- Instead of a handler function, the name of a module can be given; the
+-- module is loaded the first time the page is opened, and must then register
+-- the page itself. This keeps the templates and code of rarely-used pages out
+-- of memory until they are needed.
+--
 -- @tparam string page The name of the chrome page to register.
--- @tparam function func The handler function for the chrome page.
+-- @tparam function|string func The handler function for the chrome page, or
+-- the name of the module that provides it.
 -- @tparam function on_first_visual_func An optional handler function
 -- for the chrome page, called when the page first finishes loading.
 -- @tparam table export_funcs An optional table of functions to
@@ -190,6 +204,17 @@ function _M.add(page, func, on_first_visual_func, export_funcs)
         "invalid chrome page name (string expected, got "..type(page)..")")
     assert(string.match(page, "^[%w%-]+$"),
         "illegal characters in chrome page name: " .. page)
+
+    if type(func) == "string" then
+        assert(on_first_visual_func == nil and export_funcs == nil,
+            "lazily registered chrome pages cannot have handlers")
+        -- A module that is already loaded has registered its page
+        if package.loaded[func] then return end
+        _M.remove(page)
+        lazy_modules[page] = func
+        return
+    end
+
     assert(type(func) == "function",
         "invalid chrome handler (function expected, got "..type(func)..")")
     assert(type(on_first_visual_func) == "nil"
@@ -201,6 +226,8 @@ function _M.add(page, func, on_first_visual_func, export_funcs)
         assert(type(export_func) == "function")
     end
 
+    local was_lazy = lazy_modules[page]
+    lazy_modules[page] = nil
     handlers[page] = func
     on_first_visual_handlers[page] = on_first_visual_func
     page_funcs[page] = export_funcs
@@ -213,6 +240,13 @@ function _M.add(page, func, on_first_visual_func, export_funcs)
                 end
             end
         end
+
+        -- Running web processes missed the page's functions at startup
+        if was_lazy then
+            for name in pairs(page_funcs[page]) do
+                wm:emit_signal("register-function", page, name)
+            end
+        end
     end
 end
 
@@ -221,6 +255,21 @@ end
 function _M.remove(page)
     handlers[page] = nil
     on_first_visual_handlers[page] = nil
+    lazy_modules[page] = nil
+end
+
+-- Load the module of a lazily registered page
+local function load_page_module(page)
+    local module = lazy_modules[page]
+    if not module then return end
+    msg.verbose("loading %s for luakit://%s/", module, page)
+    local ok, err = xpcall(function () require(module) end, debug.traceback)
+    if not ok then
+        msg.error("error loading %s: %s", module, err)
+    elseif lazy_modules[page] then
+        msg.error("module %s did not register luakit://%s/", module, page)
+    end
+    lazy_modules[page] = nil
 end
 
 luakit.register_scheme("luakit")
@@ -232,6 +281,7 @@ webview.add_signal("init", function (view)
         local page, path = string.match(uri, "^luakit://([^/]+)/?(.*)")
         if not page then return end
 
+        load_page_module(page)
         local func = handlers[page]
         if func then
             -- Give the handler function everything it may need
@@ -310,7 +360,7 @@ wm:add_signal("function-call", function (_, page_id, page_name, func_name, id, a
     local view
     for _, w in pairs(window.bywidget) do
         for _, v in pairs(w.tabs.children) do
-            if v.id == page_id then view = v end
+            if not v.placeholder and v.id == page_id then view = v end
         end
     end
     -- Call Lua function, return result
@@ -46,7 +46,59 @@ end
 
 local completers = {}
 
-local function parse(buf)
+-- Results for input that extends `prefix` can be found by filtering the
+-- complete results for `prefix` with the completer's `filter` function
+local function narrow(cgroup, entry, buf)
+    local ret = {}
+    for _, cr in ipairs(entry.results) do
+        if cgroup.filter(cr, buf) then ret[#ret+1] = cr end
+    end
+    return ret
+end
+
+-- Find the cached results for the longest prefix of `buf`
+local function cached_prefix(cache, buf)
+    for i = #buf - 1, 0, -1 do
+        local entry = cache[buf:sub(1, i)]
+        if entry then return entry end
+    end
+end
+
+-- Get the results of a completion group for some input. Results are cached
+-- for the rest of the completion session. Completers marked `async` (or
+-- whose `async` function returns true) are only run after the input has
+-- stopped changing for `completion.delay` milliseconds; until then, narrowed
+-- results for a shorter input are shown, and the query is added to
+-- `ctx.pending`.
+local function get_results(ctx, grp, buf)
+    local cgroup = assert(completers[grp], "No completion group '".. grp .. "'")
+    local cache = ctx.state.cache[grp]
+    if not cache then
+        cache = {}
+        ctx.state.cache[grp] = cache
+    end
+
+    local entry = cache[buf]
+    if entry then return entry.results end
+
+    local prefix = cgroup.filter and cached_prefix(cache, buf)
+    if prefix and prefix.complete then
+        entry = { results = narrow(cgroup, prefix, buf), complete = true }
+    elseif prefix and (cgroup.async == true or (cgroup.async and cgroup.async())) then
+        ctx.provisional = true
+        ctx.pending[grp] = ctx.pending[grp] or {}
+        ctx.pending[grp][buf] = true
+        return narrow(cgroup, prefix, buf)
+    else
+        local results, complete = cgroup.func(buf)
+        entry = { results = assert(results), complete = complete }
+    end
+
+    cache[buf] = entry
+    return entry.results
+end
+
+local function parse(ctx, buf)
     local function match_step (state, matches)
         local new_states = {}
 
@@ -64,8 +116,7 @@ local function parse(buf)
                     table.insert(new_states, lousy.util.table.join(s, { buf = s.buf:sub(#m+1), pos = s.pos+1 }))
                 end
             elseif nup.grp then -- completion group name
-                local cgroup = assert(completers[nup.grp], "No completion group '".. nup.grp .. "'")
-                local cresults = assert(cgroup.func(s.buf))
+                local cresults = get_results(ctx, nup.grp, s.buf)
 
                 for _, cr in ipairs(cresults) do
                     local crf = type(cr) == "table" and cr.format or cr
@@ -108,8 +159,8 @@ local function parse(buf)
     return matches
 end
 
-local function complete(buf)
-    local matches, rows = parse(buf).partial, {}
+local function complete(ctx, buf)
+    local matches, rows = parse(ctx, buf).partial, {}
     local pat2lit = function (p) return p == "%s+" and " " or p end
     local prev_grp
 
@@ -129,6 +180,64 @@ local function complete(buf)
     return rows
 end
 
+-- Rebuild the completion menu for the current input text
+local function refresh(w, state, keep_cursor)
+    local ctx = { state = state, pending = {} }
+    local rows = state.rows[state.text]
+    if not rows then
+        rows = complete(ctx, state.text)
+        -- Provisional rows are replaced once pending queries have run
+        if not ctx.provisional then state.rows[state.text] = rows end
+    end
+
+    -- Restart the delay until pending queries are run
+    state.pending = ctx.pending
+    if state.timer.started then state.timer:stop() end
+    if next(ctx.pending) then state.timer:start() end
+
+    if not rows[2] and not next(ctx.pending) then
+        _M.exit_completion(w)
+        return
+    end
+
+    -- Prevent callbacks triggering recursive updates.
+    state.lock = true
+    if state.built then
+        w.menu:set_rows(rows, keep_cursor)
+    else
+        w.menu:build(rows)
+    end
+    if rows[2] then
+        w.menu:show()
+        if not state.built then
+            state.built = true
+            w.menu:move_down()
+        end
+    else
+        -- Nothing to show until the pending queries have run
+        w.menu:hide()
+    end
+    state.lock = false
+end
+
+-- Run the queries of async completers once the input has settled
+local function run_pending(w, state)
+    state.timer:stop()
+    if data[w] ~= state or not w:is_mode("completion") then return end
+
+    for grp, bufs in pairs(state.pending) do
+        local cache = state.cache[grp]
+        for buf in pairs(bufs) do
+            local results, complete = completers[grp].func(buf)
+            cache[buf] = { results = assert(results), complete = complete }
+        end
+    end
+    state.pending = {}
+
+    -- Keep the selected row, if any, when the results change
+    refresh(w, state, true)
+end
+
 --- Update the list of completions for some input text.
 -- @tparam table w The current window table.
 -- @tparam string text The current input text.
@@ -150,21 +259,7 @@ function _M.update_completions(w, text, pos)
     -- Update left and right strings
     state.text, state.pos = text, pos
 
-    local rows = complete(text)
-
-    if rows[2] then
-        -- Prevent callbacks triggering recursive updates.
-        state.lock = true
-        w.menu:build(rows)
-        w.menu:show()
-        if not state.built then
-            state.built = true
-            if rows[2] then w.menu:move_down() end
-        end
-        state.lock = false
-    else
-        _M.exit_completion(w)
-    end
+    refresh(w, state)
 end
 
 local function input_change_cb (w)
@@ -182,10 +277,14 @@ end
 
 new_mode("completion", {
     enter = function (w)
-        -- Clear state
-        local state = {}
+        -- Clear state; completer results and menu rows are cached per input
+        -- text for the rest of the session
+        local state = { cache = {}, rows = {}, pending = {} }
         data[w] = state
 
+        state.timer = timer{ interval = settings.get_setting("completion.delay") }
+        state.timer:add_signal("timeout", function () run_pending(w, state) end)
+
         -- Save original text and cursor position
         local input = w.ibar.input
         state.orig_text = input.text
@@ -211,6 +310,8 @@ new_mode("completion", {
     move_cursor = input_change_cb,
 
     leave = function (w)
+        local state = data[w]
+        if state.timer.started then state.timer:stop() end
         w.menu:hide()
         w.menu:remove_signals("changed")
     end,
@@ -294,21 +395,35 @@ local function sql_like_globber(term)
     return "%" .. escaped:gsub("%s+", "%%") .. "%"
 end
 
+-- Match a result against the input like the `sql_like_globber()` pattern
+-- does against the lowercase `text` column
+local function like_filter(cr, buf)
+    local pos = 1
+    for term in buf:lower():gmatch("%S+") do
+        local _, e = cr.match:find(term, pos, true)
+        if not e then return false end
+        pos = e + 1
+    end
+    return true
+end
+
 settings.register_settings({
     ["completion.history.order"] = {
         type = "string",
-        default = "visits",
+        default = "frecency",
         desc = [=[
             A string indicating how history items should be sorted in
             completion. Possible values are:
 
+            - `frecency`: frequently and recently visited websites, and
+              bookmarks, first
             - `visits`: most visited websites first
             - `last_visit`: most recent websites first
             - `title`: sort by title, alphabetically
             - `uri`: sort by website address, alphabetically
         ]=],
         validator = function (v)
-            local t = {visits = true, last_visit = true, title = true, uri = true}
+            local t = {frecency = true, visits = true, last_visit = true, title = true, uri = true}
             return t[v]
         end
     },
@@ -316,36 +431,70 @@ settings.register_settings({
         type = "number", min = 1,
         default = 25,
         desc = "Number of completion items for history and bookmarks."
-    }
+    },
+    ["completion.delay"] = {
+        type = "number", min = 1,
+        default = 100,
+        desc = [=[
+            Time in milliseconds to wait for typing to pause before
+            searching history and bookmarks again. Until then, earlier
+            results are narrowed down to the current input.
+        ]=],
+    },
 })
 
 completers.history = {
     header = { "History", "URI" },
+    -- Only database queries are deferred; the URL index is fast enough
+    async = function ()
+        return settings.get_setting("completion.history.order") ~= "frecency"
+    end,
+    filter = like_filter,
     func = function (buf)
         local order = settings.get_setting("completion.history.order")
+        local max_items = settings.get_setting("completion.max_items")
+        local ret = {}
+
+        -- Frecency ranking is done by the in-memory URL index
+        if order == "frecency" then
+            local rows = url_index.query(buf, max_items)
+            for _, row in ipairs(rows) do
+                table.insert(ret, {
+                    escape(row.title) or "", escape(row.uri),
+                    format = {{ lit = row.uri }},
+                    buf = row.uri,
+                    match = row.text,
+                })
+            end
+            return ret, #rows < max_items
+        end
+
         local desc = (order == "visits" or order == "last_visit") and " DESC" or ""
-        local term, ret, sql = buf, {}, [[
+        local term, sql = buf, [[
             SELECT uri, title, lower(uri||ifnull(title,'')) AS text
             FROM history WHERE text LIKE ? ESCAPE '\'
             ORDER BY
-        ]] .. order .. desc .. " LIMIT " .. settings.get_setting("completion.max_items")
+        ]] .. order .. desc .. " LIMIT " .. max_items
 
         local rows = history.db:exec(sql, { sql_like_globber(term) })
-        if not rows[1] then return {} end
+        if not rows[1] then return {}, true end
 
         for _, row in ipairs(rows) do
             table.insert(ret, {
                 escape(row.title) or "", escape(row.uri),
                 format = {{ lit = row.uri }},
-                buf = row.uri
+                buf = row.uri,
+                match = row.text,
             })
         end
-        return ret
+        return ret, #rows < max_items
     end,
 }
 
 completers.bookmarks = {
     header = { "Bookmarks", "URI" },
+    async = true,
+    filter = like_filter,
     func = function (buf)
         local term, ret, sql = buf, {}, [[
             SELECT uri, title, lower(uri||ifnull(title,'')||ifnull(tags,'')) AS text
@@ -354,17 +503,18 @@ completers.bookmarks = {
         ]] .. settings.get_setting("completion.max_items")
 
         local rows = bookmarks.db:exec(sql, { sql_like_globber(term) })
-        if not rows[1] then return {} end
+        if not rows[1] then return {}, true end
 
         for _, row in ipairs(rows) do
             local title = row.title ~= "" and row.title or row.uri
             table.insert(ret, {
                 escape(title), escape(row.uri),
                 format = {{ lit = row.uri }},
-                buf = row.uri
+                buf = row.uri,
+                match = row.text,
             })
         end
-        return ret
+        return ret, #rows < settings.get_setting("completion.max_items")
     end,
 }
 
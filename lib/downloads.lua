@@ -125,7 +125,7 @@ function _M.do_open(d, w)
     end
 end
 
-local status_timer = timer{interval=300}
+local status_timer = timer{interval=300, slack=100}
 status_timer:add_signal("timeout", function ()
     local running = 0
     for d, data in pairs(dls) do
@@ -69,6 +69,12 @@ function _M.init()
         SET title = ?
         WHERE id = ?
     ]]
+
+    -- Load history into the URL suggestion index
+    local rows = _M.db:exec [[ SELECT uri, title, visits, last_visit FROM history ]]
+    for _, row in ipairs(rows) do
+        url_index.add(row.uri, row.title, row.visits or 1, row.last_visit or 0)
+    end
 end
 
 luakit.idle_add(_M.init)
@@ -94,12 +100,16 @@ function _M.add(uri, title, update_visits)
     if item then
         if update_visits ~= false then
             query_update_visits:exec{os.time(), item.id}
+            url_index.add(uri, title, 1, os.time())
+        elseif title then
+            url_index.add(uri, title, 0, 0)
         end
         if title then
             query_update_title:exec{title, item.id}
         end
     else
         query_insert:exec{uri, title, 1, os.time()}
+        url_index.add(uri, title, 1, os.time())
     end
 end
 
@@ -379,14 +379,19 @@ local export_funcs = {
 
     history_clear_all = function (_)
         history.db:exec [[ DELETE FROM history ]]
+        url_index.clear()
     end,
 
     history_clear_list = function (_, ids)
         if not ids or #ids == 0 then return end
         local marks = {}
         for i=1,#ids do marks[i] = "?" end
+        marks = table.concat(marks, ",")
+        local rows = history.db:exec("SELECT uri FROM history WHERE id IN ("
+            .. marks .. " )", ids)
         history.db:exec("DELETE FROM history WHERE id IN ("
-            .. table.concat(marks, ",") .. " )", ids)
+            .. marks .. " )", ids)
+        for _, row in ipairs(rows) do url_index.remove(row.uri) end
     end,
 
     initial_search_term = function (_)
@@ -48,6 +48,120 @@ local function convert_binds_table(binds)
     return converted
 end
 
+-- Compiled lookup tables, indexed by binds table
+local compiled = setmetatable({}, { __mode = "k" })
+-- Incremented by add_bind(), remove_bind() and remap_bind(). Bind entries are
+-- shared between binds tables (window binds are joined from mode binds), so
+-- any change recompiles every binds table when it is next used.
+local generation = 0
+
+-- The literal characters every match of a buffer bind pattern starts with
+local function literal_prefix(pat)
+    local lit, i = {}, 2 -- Skip the leading ^
+    while i <= #pat do
+        local c, len = pat:sub(i, i), 1
+        if c == "%" then
+            c, len = pat:sub(i+1, i+1), 2
+            if c == "" or c:match("%w") then break end
+        elseif c:match("[%^%$%(%)%.%[%]%*%+%-%?]") then
+            break
+        end
+        -- Characters followed by a quantifier are optional
+        if pat:sub(i+len, i+len):match("[%*%+%-%?]") then break end
+        lit[#lit+1] = c
+        i = i + len
+    end
+    return table.concat(lit)
+end
+
+local function trie_insert(trie, str, index)
+    local node = trie
+    node.count = node.count + 1
+    for p = 1, #str do
+        local b = str:byte(p)
+        local child = node.children[b]
+        if not child then
+            child = { binds = {}, children = {}, count = 0 }
+            node.children[b] = child
+        end
+        node = child
+        node.count = node.count + 1
+    end
+    table.insert(node.binds, index)
+end
+
+-- Walk the trie along `str`, adding the binds of each node passed to
+-- `found`; returns the last node, or nil if `str` leaves the trie
+local function trie_walk(trie, str, found)
+    local node = trie
+    for _, i in ipairs(node.binds) do found[#found+1] = i end
+    for p = 1, #str do
+        node = node.children[str:byte(p)]
+        if not node then return nil end
+        for _, i in ipairs(node.binds) do found[#found+1] = i end
+    end
+    return node
+end
+
+-- Split a command binding string into its long and short forms
+local function command_names(b)
+    local cmds = {}
+    for _, cmd in ipairs(util.string.split(b:gsub("^:", ""), ",%s+:")) do
+        if string.match(cmd, "^([%-%w]+)%[(%w+)%]") then
+            local l, r = string.match(cmd, "^([%-%w]+)%[(%w+)%]")
+            table.insert(cmds, l..r)
+            table.insert(cmds, l)
+        else
+            table.insert(cmds, cmd)
+        end
+    end
+    return cmds
+end
+
+-- Compile a binds table into lookup tables of bind indices: key and button
+-- binds are hashed by trigger, command binds by name, and buffer binds are
+-- stored in a trie by the literal prefix of their pattern. Compiled tables
+-- are cached until the binds change, so the cost of finding a bind doesn't
+-- depend on the number of binds.
+local function compile(binds)
+    local c = compiled[binds]
+    if c and c.generation == generation and c.n == #binds then return c end
+
+    local converted = convert_binds_table(binds)
+    c = {
+        generation = generation,
+        n = #binds,
+        binds = converted,
+        any = {},
+        keys = {},
+        cmds = {},
+        bufs = {},
+        trie = { binds = {}, children = {}, count = 0 },
+    }
+    for i, m in ipairs(converted) do
+        local b = m[1]
+        if b == "<any>" then
+            table.insert(c.any, i)
+        elseif b:match("^^") then
+            table.insert(c.bufs, i)
+            trie_insert(c.trie, literal_prefix(b), i)
+        elseif b:match("^:") then
+            for _, cmd in ipairs(command_names(b)) do
+                local list = c.cmds[cmd] or {}
+                if list[#list] ~= i then table.insert(list, i) end
+                c.cmds[cmd] = list
+            end
+        else
+            c.keys[b] = c.keys[b] or {}
+            table.insert(c.keys[b], i)
+        end
+    end
+
+    compiled[binds] = c
+    compiled[converted] = c
+    return c
+end
+
 --- Set of modifiers to ignore.
 -- @readwrite
 _M.ignore_mask = {
@@ -73,6 +187,12 @@ _M.mod_map = {
     Alt = "Mod1",
 }
 
+-- Lowercase modifier names accepted by parse_mods()
+local recognized_mods = {
+    shift = true, lock = true, control = true,
+    mod1 = true, mod2 = true, mod3 = true, mod4 = true, mod5 = true,
+}
+
 --- Parse a table of modifier keys into a string.
 -- @tparam table mods The table of modifier keys.
 -- @tparam[opt] boolean remove_shift Remove the shift key from the modifier
@@ -81,11 +201,10 @@ _M.mod_map = {
 -- @treturn string A string of key names, separated by hyphens (-).
 function _M.parse_mods(mods, remove_shift)
     local t = {}
-    local recognized_mods = { "shift", "lock", "control", "mod1", "mod2", "mod3", "mod4", "mod5" }
     for _, mod in ipairs(mods) do
         if not _M.ignore_mask[mod] then
             mod = string.lower(_M.mod_map[mod] or _M.map[mod] or mod)
-            assert(util.table.hasitem(recognized_mods, mod), "unrecognized modifier '"..mod.."'")
+            assert(recognized_mods[mod], "unrecognized modifier '"..mod.."'")
             t[mod] = true
         end
     end
@@ -114,13 +233,22 @@ end
 -- called.
 -- @treturn boolean `true` if an 'any' binding was ran successfully.
 function _M.match_any(object, binds, args)
-    binds = convert_binds_table(binds)
-    for _, m in ipairs(binds) do
-        local b, a, o = unpack(m)
-        if b == "<any>" then
-            if a.func(object, join(o, args), o) ~= false then
-                return true
-            end
+    local c = compile(binds)
+    for _, i in ipairs(c.any) do
+        local _, a, o = unpack(c.binds[i])
+        if a.func(object, join(o, args), o) ~= false then
+            return true
+        end
+    end
+    return false
+end
+
+local function match_trigger(object, binds, trigger, args)
+    local c = compile(binds)
+    for _, i in ipairs(c.keys[trigger] or {}) do
+        local _, a, o = unpack(c.binds[i])
+        if a.func(object, join(o, args), o) ~= false then
+            return true
         end
     end
     return false
@@ -142,16 +270,7 @@ end
 -- called.
 -- @treturn boolean `true` if a key binding was ran successfully.
 function _M.match_key(object, binds, mods, key, args)
-    binds = convert_binds_table(binds)
-    for _, m in ipairs(binds) do
-        local b, a, o = unpack(m)
-        if b == "<".. (mods and (mods.."-") or "") .. key .. ">" then
-            if a.func(object, join(o, args), o) ~= false then
-                return true
-            end
-        end
-    end
-    return false
+    return match_trigger(object, binds, "<".. (mods and (mods.."-") or "") .. key .. ">", args)
 end
 
 --- Match any button binding in a given table of bindings.
@@ -170,16 +289,7 @@ end
 -- called.
 -- @treturn boolean `true` if a key binding was ran successfully.
 function _M.match_but(object, binds, mods, button, args)
-    binds = convert_binds_table(binds)
-    for _, m in ipairs(binds) do
-        local b, a, o = unpack(m)
-        if b == "<" .. (mods and (mods.."-") or "") .. "Mouse" .. button .. ">" then
-            if a.func(object, join(o, args), o) ~= false then
-                return true
-            end
-        end
-    end
-    return false
+    return match_trigger(object, binds, "<" .. (mods and (mods.."-") or "") .. "Mouse" .. button .. ">", args)
 end
 
 --- Determine if a string is a partial match for a Lua pattern
@@ -216,25 +326,36 @@ end
 -- @treturn boolean `true` if a partial match exists.
 function _M.match_buf(object, binds, buffer, args)
     assert(buffer and string.match(buffer, "%S"), "invalid buffer")
-    binds = convert_binds_table(binds)
-
-    local has_partial_match = false
-    for _, m in ipairs(binds) do
-        local b, a, o = unpack(m)
-        if b:match("^^") then
-            if buffer:match(b) then
-                local params = {join(o, args, { buffer = buffer }), o}
-                if a.compat == "buffer" then table.insert(params, 1, buffer) end
-                if a.func(object, unpack(params)) ~= false then
-                    return true, true
-                end
-            end
-            if is_partial_match(buffer, b) then
-                has_partial_match = true
+    local c = compile(binds)
+
+    -- Only binds whose literal prefix is a prefix of the buffer can match
+    local candidates = {}
+    trie_walk(c.trie, buffer, candidates)
+    table.sort(candidates)
+    for _, i in ipairs(candidates) do
+        local b, a, o = unpack(c.binds[i])
+        if buffer:match(b) then
+            local params = {join(o, args, { buffer = buffer }), o}
+            if a.compat == "buffer" then table.insert(params, 1, buffer) end
+            if a.func(object, unpack(params)) ~= false then
+                return true, true
             end
         end
     end
-    return false, has_partial_match
+
+    -- Binds whose literal prefix starts with the buffer (ignoring any count)
+    -- are partial matches; binds with a shorter literal prefix are checked
+    local shorter = {}
+    local node = trie_walk(c.trie, buffer:match("^%d*(.*)$"), shorter)
+    if node and node.count > 0 then
+        return false, true
+    end
+    for _, i in ipairs(shorter) do
+        if is_partial_match(buffer, c.binds[i][1]) then
+            return false, true
+        end
+    end
+    return false, false
 end
 
 --- Try and match a command or buffer binding in a given table of bindings
@@ -247,7 +368,7 @@ end
 -- @treturn boolean `true` if either type of binding was matched and called.
 function _M.match_cmd(object, binds, buffer, args)
     assert(buffer and string.match(buffer, "%S"), "invalid buffer")
-    binds = convert_binds_table(binds)
+    local c = compile(binds)
 
     -- The command is the first word in the buffer string
     local command  = string.match(buffer, "^(%S+)")
@@ -256,27 +377,23 @@ function _M.match_cmd(object, binds, buffer, args)
 
     -- Set args.cmd to tell buf/any binds they were called from match_cmd
     args = join(args or {}, {
-        binds = binds,
+        binds = c.binds,
         cmd = buffer,
         arg = argument,
     })
 
-    for _, m in ipairs(binds) do
-        local b, a, o = unpack(m)
-        -- split command binding string into long and short forms
-        local cmds = {}
-        for _, cmd in ipairs(util.string.split(b:gsub("^:", ""), ",%s+:")) do
-            if string.match(cmd, "^([%-%w]+)%[(%w+)%]") then
-                local l, r = string.match(cmd, "^([%-%w]+)%[(%w+)%]")
-                table.insert(cmds, l..r)
-                table.insert(cmds, l)
-            else
-                table.insert(cmds, cmd)
-            end
-        end
+    -- Binds are tried in order, as if all binds were checked
+    local candidates = {}
+    for _, list in ipairs({ c.cmds[command] or {}, c.bufs, c.any }) do
+        for _, i in ipairs(list) do candidates[#candidates+1] = i end
+    end
+    table.sort(candidates)
+
+    for _, i in ipairs(candidates) do
+        local b, a, o = unpack(c.binds[i])
 
         -- Command matching
-        if b:match("^:") and util.table.hasitem(cmds, command) then
+        if b:match("^:") then
             local params = {join(o, args, { argument = argument }), o}
             if a.compat then table.insert(params, 1, argument) end
             if a.func(object, unpack(params)) ~= false then
@@ -320,7 +437,7 @@ end
 function _M.hit(object, binds, mods, key, args)
     -- Convert keys using map
     key = _M.map[key] or key
-    binds = convert_binds_table(binds)
+    binds = compile(binds).binds
 
     if not key then return false end
     local len = utf8.len(key)
@@ -358,6 +475,8 @@ function _M.hit(object, binds, mods, key, args)
     if util.table.hasitem(omods, "Lock") then
         local uc, lc = luakit.wch_upper(key), luakit.wch_lower(key)
         key = key == uc and lc or uc
+        -- Modifier tables are shared between key events; don't modify them
+        omods = util.table.clone(omods)
         table.remove(omods, util.table.hasitem(omods, "Lock"))
     end
     mods = _M.parse_mods(omods, type(key) == "string" and len == 1)
@@ -422,6 +541,7 @@ function _M.add_bind (binds, bind, action, opts)
     bind = convert_bind_syntax(bind)
     _M.remove_bind(binds, bind)
     table.insert(binds, { bind, action, opts or {} })
+    generation = generation + 1
     msg.verbose("added bind %s", bind)
 end
 
@@ -438,6 +558,7 @@ function _M.remove_bind (binds, bind)
     for i, m in ipairs(binds) do
         if m[1] == bind then
             table.remove(binds, i)
+            generation = generation + 1
             msg.verbose("removed bind %s", bind)
             return m[2], m[3]
         end
@@ -467,6 +588,7 @@ function _M.remap_bind (binds, new, old, keep)
                 _M.add_bind(binds, new, m[2], m[3])
             else
                 m[1] = new
+                generation = generation + 1
             end
             return
         end
@@ -14,6 +14,7 @@ return {
     uri    = require("lousy.uri"),
     load   = require("lousy.load"),
     pickle = require("lousy.pickle"),
+    tasks  = require("lousy.tasks"),
 }
 
 -- vim: et:sw=4:ts=8:sts=4:tw=80
@@ -0,0 +1,150 @@
+--- Cooperative background tasks.
+--
+-- This module runs deferred work in small slices, so that it doesn't delay
+-- input handling or redrawing. A task is a function run in its own coroutine;
+-- it should call `yield()` regularly, for example after each item of a long
+-- loop.
+--
+-- Tasks only run when luakit is idle, in slices of at most `budget`
+-- milliseconds. Between slices, luakit handles all pending input events and
+-- redraws, which always take precedence over tasks. Runnable tasks with a
+-- higher priority run first; tasks of equal priority take turns.
+--
+-- Tasks may also call asynchronous functions, such as
+-- `luakit.website_data.fetch()`; the task waits until the function returns,
+-- without blocking other tasks.
+--
+-- # Example usage:
+--
+--     local tasks = require "lousy.tasks"
+--
+--     tasks.spawn(function ()
+--         for _, v in ipairs(views) do
+--             refresh(v)
+--             tasks.yield()
+--         end
+--     end)
+--
+-- @module lousy.tasks
+-- @copyright 2026 luakit developers
+
+local _M = {}
+
+--- The time, in milliseconds, that tasks may run for before luakit handles
+-- pending events. A task that doesn't yield can exceed it.
+-- @type number
+-- @readwrite
+_M.budget = 4
+
+--- Task counters.
+--
+-- - `spawned`: the number of tasks spawned.
+-- - `finished`: the number of tasks that returned or failed.
+-- - `slices`: the number of slices run.
+-- - `resumes`: the number of times a task was resumed by a slice.
+--
+-- @type table
+-- @readonly
+_M.stats = { spawned = 0, finished = 0, slices = 0, resumes = 0 }
+
+-- Runnable tasks, in the order they will be resumed
+local queue = {}
+-- Map from coroutine to task
+local tasks = setmetatable({}, { __mode = "k" })
+local scheduled = false
+
+local run_slice
+
+local function schedule()
+    if not scheduled then
+        scheduled = true
+        luakit.idle_add(run_slice)
+    end
+end
+
+-- Queue a task behind all tasks of the same or a higher priority
+local function enqueue(task)
+    local i = #queue
+    while i > 0 and queue[i].priority < task.priority do i = i - 1 end
+    table.insert(queue, i + 1, task)
+    schedule()
+end
+
+local function dequeue(task)
+    for i, t in ipairs(queue) do
+        if t == task then return table.remove(queue, i) end
+    end
+end
+
+run_slice = function ()
+    _M.stats.slices = _M.stats.slices + 1
+    local deadline = luakit.time() + _M.budget / 1000
+    repeat
+        local task = table.remove(queue, 1)
+        if not task then break end
+        _M.stats.resumes = _M.stats.resumes + 1
+        local ok, err = coroutine.resume(task.co)
+        if not ok then
+            _M.stats.finished = _M.stats.finished + 1
+            msg.error("background task failed: %s", debug.traceback(task.co, err))
+        end
+    until luakit.time() >= deadline
+
+    scheduled = #queue > 0
+    return scheduled
+end
+
+--- Run a function as a background task.
+-- @tparam function func The task function.
+-- @tparam[opt] number priority The task priority; higher priority tasks run
+-- first.
+-- @default 0
+-- @treturn table The task, which can be passed to `cancel()`.
+function _M.spawn(func, priority)
+    assert(type(func) == "function", "invalid task function")
+    assert(priority == nil or type(priority) == "number", "invalid task priority")
+
+    local task = { priority = priority or 0 }
+    task.co = coroutine.create(function ()
+        func()
+        if not task.cancelled then
+            _M.stats.finished = _M.stats.finished + 1
+        end
+    end)
+    tasks[task.co] = task
+    _M.stats.spawned = _M.stats.spawned + 1
+    enqueue(task)
+    return task
+end
+
+--- Let other tasks, input handling and redrawing run. The current task
+-- continues in the same or a later slice.
+--
+-- Must be called from a task.
+function _M.yield()
+    local task = tasks[coroutine.running() or false]
+    assert(task, "tasks.yield() called outside of a task")
+    if not task.cancelled then enqueue(task) end
+    coroutine.yield()
+end
+
+--- Stop a task. The task is not resumed again; if it is the current task,
+-- it stops at its next call to `yield()`.
+-- @tparam table task The task, as returned by `spawn()`.
+function _M.cancel(task)
+    assert(type(task) == "table" and task.co, "invalid task")
+    if task.cancelled or coroutine.status(task.co) == "dead" then return end
+    task.cancelled = true
+    dequeue(task)
+    _M.stats.finished = _M.stats.finished + 1
+end
+
+--- Get the number of tasks that are waiting to run.
+-- @treturn integer The number of runnable tasks.
+function _M.pending()
+    return #queue
+end
+
+return _M
+
+-- vim: et:sw=4:ts=8:sts=4:tw=80
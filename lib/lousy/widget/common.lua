@@ -5,6 +5,7 @@
 
 local window = require("window")
 local lousy = require("lousy")
+local frame = require("lousy.widget.frame")
 
 local _M = {}
 
@@ -22,17 +23,32 @@ _M.add_widget = function (widgets, widget)
     return widget
 end
 
+-- Map from widgets table to the function that updates them on a window
+local updaters = setmetatable({}, { __mode = "k" })
+
 --- Update all widgets in `widgets` on the given window.
+--
+-- Widgets are updated before the next frame of the window is drawn; if they
+-- are updated several times before then, they are only updated once, with
+-- the arguments given last.
 -- @tparam table widgets A table of widgets
 -- @tparam table w A window table
 _M.update_widgets_on_w = function (widgets, w, ...)
     assert(type(widgets) == "table")
     assert(w.win.type == "window")
-    for _, widget in ipairs(widgets) do
-        if window.ancestor(widget) == w then
-            widgets.update(w, widget, ...)
+    local updater = updaters[widgets]
+    if not updater then
+        updater = function (uw, ...)
+            if not uw.win then return end -- Window was closed
+            for _, widget in ipairs(widgets) do
+                if window.ancestor(widget) == uw then
+                    widgets.update(uw, widget, ...)
+                end
+            end
         end
+        updaters[widgets] = updater
     end
+    frame.schedule(w.win, updater, w, ...)
 end
 
 return _M
@@ -0,0 +1,77 @@
+--- Per-frame widget updates.
+--
+-- This module coalesces widget updates: instead of updating a widget each
+-- time something it shows changes, an update function is scheduled, and is
+-- run at most once before the next frame is drawn. During page loads,
+-- properties like the title and load progress can change many times per
+-- frame; only the last change is rendered.
+--
+-- Updates are tied to the frame clock of a widget, so updates for widgets
+-- that aren't visible are delayed until they are shown.
+--
+-- @module lousy.widget.frame
+-- @copyright 2026 luakit developers
+
+local _M = {}
+
+--- Update counters.
+--
+-- - `scheduled`: the number of updates scheduled.
+-- - `run`: the number of updates run.
+-- - `coalesced`: the number of updates merged into an already scheduled
+--   update.
+--
+-- @type table
+-- @readonly
+_M.stats = { scheduled = 0, run = 0, coalesced = 0 }
+
+-- Map from widget to an array of scheduled functions, each of which maps to
+-- the arguments it will be called with
+local pending = setmetatable({}, { __mode = "k" })
+
+local function run(wi)
+    local queue = pending[wi]
+    if not queue then return end
+    pending[wi] = nil
+    for _, func in ipairs(queue) do
+        local args = queue[func]
+        _M.stats.run = _M.stats.run + 1
+        func(unpack(args, 1, args.n))
+    end
+end
+
+--- Schedule a function to run before the next frame of a widget is drawn.
+-- If the same function is already scheduled for the widget, it is only run
+-- once, with the arguments given last.
+-- @tparam widget wi The widget whose frame clock to use.
+-- @tparam function func The update function.
+-- @param ... Arguments for `func`.
+function _M.schedule(wi, func, ...)
+    assert(type(wi) == "widget", "invalid widget")
+    assert(type(func) == "function", "invalid update function")
+    _M.stats.scheduled = _M.stats.scheduled + 1
+
+    local queue = pending[wi]
+    if not queue then
+        queue = {}
+        pending[wi] = queue
+        wi:on_next_frame(function () run(wi) end)
+    end
+    if queue[func] then
+        _M.stats.coalesced = _M.stats.coalesced + 1
+    else
+        table.insert(queue, func)
+    end
+    queue[func] = { n = select("#", ...), ... }
+end
+
+--- Run all updates scheduled for a widget now, instead of before its next
+-- frame.
+-- @tparam widget wi The widget.
+function _M.flush(wi)
+    run(wi)
+end
+
+return _M
+
+-- vim: et:sw=4:ts=8:sts=4:tw=80
@@ -11,9 +11,8 @@ local _M = {}
 
 local data = setmetatable({}, { __mode = "k" })
 
-local function update(menu)
-    assert(data[menu] and type(menu.widget) == "widget", "invalid menu widget")
-
+-- Populate the row widgets; only changed properties are set
+local function render(menu)
     -- Get private menu widget data
     local d = data[menu]
 
@@ -22,9 +21,6 @@ local function update(menu)
     local fg, bg, font = theme.menu_fg, theme.menu_bg, theme.menu_font
     local sfg, sbg = theme.menu_selected_fg, theme.menu_selected_bg
 
-    -- Hide widget while re-drawing
-    menu.widget:hide()
-
     -- Build & populate rows
     for i = 1, math.max(d.max_rows, #(d.table)) do
         -- Get row
@@ -40,6 +36,7 @@ local function update(menu)
                 ebox = widget{type = "eventbox"},
                 hbox = widget{type = "hbox"},
                 cols = {},
+                texts = {},
             }
             rw.ebox.child = rw.hbox
             d.table[i] = rw
@@ -112,23 +109,34 @@ local function update(menu)
                 elseif not text and cell then
                     rw.hbox:remove(cell)
                     rw.cols[c] = nil
+                    rw.texts[c] = nil
                     cell:destroy()
                 end
 
                 -- Set cell props
                 local cfg
-                if text and cell and row.title then
+                if text and cell and rw.texts[c] ~= text then
                     cell.text = text
+                    rw.texts[c] = text
+                end
+                if text and cell and row.title then
                     cfg = row.fg or (c == 1 and theme.menu_primary_title_fg or theme.menu_secondary_title_fg) or fg
                     if cell.fg ~= cfg then cell.fg = cfg end
                 elseif text and cell then
-                    cell.text = text
                     cfg = (selected and (row.selected_fg or sfg)) or row.fg or fg
                     if cell.fg ~= cfg then cell.fg = cfg end
                 end
             end
         end
     end
+end
+
+local function update(menu)
+    assert(data[menu] and type(menu.widget) == "widget", "invalid menu widget")
+
+    -- Hide widget while re-drawing
+    menu.widget:hide()
+    render(menu)
     -- Show widget
     menu.widget:show()
 end
@@ -155,6 +163,14 @@ local function build(menu, rows)
     update(menu)
 end
 
+local function same_row(a, b)
+    if #a ~= #b or a.title ~= b.title or a.text ~= b.text then return false end
+    for c = 1, #a do
+        if a[c] ~= b[c] then return false end
+    end
+    return true
+end
+
 local function calc_offset(menu)
     local d = data[menu]
     if d.cursor < 1 then
@@ -166,6 +182,48 @@ local function calc_offset(menu)
     end
 end
 
+local function set_rows(menu, rows, keep_cursor)
+    assert(data[menu] and type(menu.widget) == "widget", "invalid menu widget")
+
+    -- Get private menu widget data
+    local d = data[menu]
+
+    -- Check rows
+    for _, row in ipairs(rows) do
+        assert(type(row) == "table", "invalid row in rows table")
+        assert(#row >= 1, "empty row")
+    end
+
+    -- Find the selected row in the new rows
+    local selected = keep_cursor and d.rows[d.cursor]
+    local cursor = 0
+    if selected then
+        for i, row in ipairs(rows) do
+            if not row.title and same_row(row, selected) then
+                cursor = i
+                break
+            end
+        end
+    end
+
+    d.rows = rows
+    d.nrows = #rows
+    d.cursor = cursor
+    if cursor > 0 then
+        d.offset = math.min(d.offset, math.max(d.nrows - d.max_rows + 1, 1))
+        calc_offset(menu)
+    else
+        d.offset = 1
+    end
+
+    render(menu)
+
+    -- The selected row is gone
+    if selected and cursor == 0 then
+        menu:emit_signal("changed", menu:get())
+    end
+end
+
 local function move_up(menu)
     assert(data[menu] and type(menu.widget) == "widget", "invalid menu widget")
 
@@ -265,6 +323,7 @@ local function new(args)
         widget    = widget{type = "vbox"},
         -- Add widget methods
         build     = build,
+        set_rows  = set_rows,
         update    = update,
         get       = get,
         del       = del,
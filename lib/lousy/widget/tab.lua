@@ -5,6 +5,7 @@
 
 local get_theme = require("lousy.theme").get
 local escape = require("lousy.util").escape
+local frame = require("lousy.widget.frame")
 
 local _M = {}
 
@@ -33,7 +34,13 @@ _M.label_subs = {
         end
     end,
     index = function (tl) return data[tl].index end,
-    title = function (tl) return escape(tl.title) end,
+    title = function (tl)
+        -- Tabs that haven't been loaded yet, or were discarded
+        if data[tl].view.placeholder then
+            return "<i>" .. escape(tl.title) .. "</i>"
+        end
+        return escape(tl.title)
+    end,
 }
 
 --- Format string which defines the text of each tab label
@@ -52,11 +59,18 @@ local function destroy(tl)
     data[tl] = nil
 end
 
-local function update_label(tl)
-    local label = data[tl].label
-    label.text = string.gsub(_M.label_format, "{([%w_]+)}", function (k)
+local function render_label(tl)
+    local priv = data[tl]
+    if not priv then return end -- Tab was destroyed
+    local text = string.gsub(_M.label_format, "{([%w_]+)}", function (k)
         return _M.label_subs[k](tl)
     end)
+    if priv.label.text ~= text then priv.label.text = text end
+end
+
+-- Labels are rendered at most once per frame
+local function update_label(tl)
+    frame.schedule(tl.widget, render_label, tl)
 end
 
 local function set_current(tl, current)
@@ -123,6 +137,10 @@ local function new(view, index)
         ["property::uri"] = function ()
             update_title_and_label(tl)
         end,
+        ["property::placeholder"] = function ()
+            update_title_and_label(tl)
+            update_label(tl)
+        end,
         ["load-status"] = function (_, status)
             if status == "provisional" then data[tl].no_title = true end
             update_title_and_label(tl)
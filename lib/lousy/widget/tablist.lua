@@ -5,8 +5,10 @@
 -- @copyright 2010 Mason Larobina <mason.larobina@gmail.com>
 
 local signal = require "lousy.signal"
+local lousy_util = require "lousy.util"
 local get_theme = require("lousy.theme").get
 local tab = require "lousy.widget.tab"
+local frame = require "lousy.widget.frame"
 local settings = require "settings"
 local window = require "window"
 
@@ -17,6 +19,13 @@ local _M = {}
 -- @readwrite
 _M.min_width = 100
 
+--- Number of tabs to create beyond each end of the visible part of the
+-- tablist. Only the tabs in or near view have widgets; the rest of the
+-- tablist is filled with empty space.
+-- @type number
+-- @readwrite
+_M.overscan = 10
+
 local data = setmetatable({}, { __mode = "k" })
 
 local function destroy(tlist)
@@ -27,6 +36,20 @@ local function destroy(tlist)
     data[tlist] = nil
 end
 
+-- The size of each tab along the tablist, measured from a visible tab
+local function get_tab_size(tlist)
+    local priv = data[tlist]
+    local size = priv.orientation == "horizontal" and "width" or "height"
+    for _, tl in pairs(priv.tabs) do
+        local tab_size = tl.widget[size]
+        if tab_size > 1 then
+            priv.tab_size = tab_size
+            break
+        end
+    end
+    return priv.tab_size
+end
+
 local function scroll_current_tab_into_view(tlist)
     assert(data[tlist])
     if not data[tlist].notebook then return end -- switching notebook
@@ -40,19 +63,17 @@ local function scroll_current_tab_into_view(tlist)
     luakit.idle_add(function()
         -- Cancel if tlist already destroyed
         if not data[tlist] then return end
+        data[tlist].scroll_tab_queued = false
 
-        -- Get the currently selected tab
         local notebook = data[tlist].notebook
-        local view = notebook[notebook:current()]
-        local tl = data[tlist].tabs[view]
-        if not tl then return end
+        if not notebook or notebook:count() == 0 then return end
 
         local axis = data[tlist].orientation == "horizontal" and "x" or "y"
         local size = data[tlist].orientation == "horizontal" and "width" or "height"
 
-        -- Scroll current tab into view
-        local tab_delta = tl.widget[size]
-        local tab_min = tab_delta * (tl.index-1)
+        -- Scroll current tab into view; it may not have a widget yet
+        local tab_delta = get_tab_size(tlist)
+        local tab_min = tab_delta * (notebook:current()-1)
         local tab_max = tab_min + tab_delta
         local vp_min = tlist.widget.scroll[axis]
         local vp_max = vp_min + tlist.widget[size]
@@ -63,24 +84,14 @@ local function scroll_current_tab_into_view(tlist)
         if tab_max > vp_max then -- need to scroll down
             tlist.widget.scroll = { [axis] = tlist.widget.scroll[axis] + (tab_max - vp_max) }
         end
-
-        data[tlist].scroll_tab_queued = false
         return false
     end)
 end
 
-local function regenerate_tab_indices(tlist, a, b)
-    if not data[tlist].notebook then return end -- switching notebook
-    local low, high = a or 1, b or data[tlist].notebook:count()
-    local views = data[tlist].notebook.children
-    local max_pad_len = #tostring(data[tlist].notebook:count())
-
-    for i=low, high do
-        local view = views[i]
-        local tl = data[tlist].tabs[view]
-        local pad_len = data[tlist].orientation == "vertical" and (max_pad_len - #tostring(i)) or 0
-        tl.index = (" "):rep(pad_len) .. tostring(i)
-    end
+local function index_text(tlist, i)
+    if data[tlist].orientation ~= "vertical" then return tostring(i) end
+    local pad_len = #tostring(#data[tlist].views) - #tostring(i)
+    return (" "):rep(pad_len) .. tostring(i)
 end
 
 local function update_tablist_visibility(tlist)
@@ -97,17 +108,16 @@ local function update_tablist_visibility(tlist)
     end
 end
 
-local function tablist_nb_page_added_cb(tlist, view, idx)
+local function create_tab(tlist, view, idx)
+    local priv = data[tlist]
     local tl = tab(view, idx)
-    data[tlist].tabs[view] = tl
+    priv.tabs[view] = tl
 
-    local orientation = data[tlist].orientation
+    local orientation = priv.orientation
     if _M.min_width and _M.min_width > 0 and orientation == "horizontal" then
         tl.widget.min_size = { w = _M.min_width }
     end
-    data[tlist].box:pack(tl.widget, { expand = orientation == "horizontal", fill = true })
-    data[tlist].box:reorder(tl.widget, idx-1)
-    regenerate_tab_indices(tlist)
+    priv.box:pack(tl.widget, { expand = orientation == "horizontal", fill = true })
 
     tl.widget:add_signal("button-release", function (_, mods, but)
         return tlist:emit_signal("tab-clicked", tl.index, mods, but)
@@ -116,16 +126,94 @@ local function tablist_nb_page_added_cb(tlist, view, idx)
         return tlist:emit_signal("tab-double-clicked", tl.index, mods, but)
     end)
 
-    update_tablist_visibility(tlist)
+    if view == priv.prev_view then tl.current = true end
+    return tl
 end
 
-local function tablist_nb_page_removed_cb(tlist, view)
-    local tl = data[tlist].tabs[view]
-    data[tlist].box:remove(tl.widget)
+local function release_tab(tlist, view)
+    local priv = data[tlist]
+    local tl = priv.tabs[view]
+    if not tl then return end
+    priv.box:remove(tl.widget)
     tl:destroy()
-    regenerate_tab_indices(tlist)
-    data[tlist].tabs[view] = nil
+    priv.tabs[view] = nil
+end
+
+local function set_spacer_size(spacer, orientation, size)
+    local min_size = spacer.min_size
+    if orientation == "horizontal" and min_size.width ~= size then
+        spacer.min_size = { w = size }
+    elseif orientation == "vertical" and min_size.height ~= size then
+        spacer.min_size = { h = size }
+    end
+end
 
+-- Give widgets to the tabs in or near view, and release the widgets of the
+-- other tabs; all other tabs are represented by the spacers around them
+local function update_tabs(tlist)
+    local priv = data[tlist]
+    if not priv or not priv.notebook then return end -- switching notebook
+    local views, n = priv.views, #priv.views
+    local axis = priv.orientation == "horizontal" and "x" or "y"
+    local size = priv.orientation == "horizontal" and "width" or "height"
+
+    local tab_size = get_tab_size(tlist)
+    local vp_min, vp_len = tlist.widget.scroll[axis], tlist.widget[size]
+    local first = math.max(1, math.floor(vp_min / tab_size) + 1 - _M.overscan)
+    local last = math.min(n, math.ceil((vp_min + vp_len) / tab_size) + _M.overscan)
+
+    local wanted = {}
+    for i = first, last do wanted[views[i]] = true end
+    for view in pairs(priv.tabs) do
+        if not wanted[view] then release_tab(tlist, view) end
+    end
+
+    -- Tabs in the order of their widgets
+    local order = {}
+    for _, view in ipairs(priv.order) do
+        if priv.tabs[view] then table.insert(order, view) end
+    end
+    for i = first, last do
+        if not priv.tabs[views[i]] then
+            create_tab(tlist, views[i], i)
+            table.insert(order, views[i])
+        end
+    end
+
+    for i = first, last do
+        local view, pos = views[i], i - first + 1
+        local tl = priv.tabs[view]
+        if order[pos] ~= view then
+            priv.box:reorder(tl.widget, pos - 1)
+            table.remove(order, lousy_util.table.hasitem(order, view))
+            table.insert(order, pos, view)
+        end
+        local index = index_text(tlist, i)
+        if tl.index ~= index then tl.index = index end
+    end
+    priv.order = order
+
+    set_spacer_size(priv.before, priv.orientation, (first - 1) * tab_size)
+    set_spacer_size(priv.after, priv.orientation, math.max(n - last, 0) * tab_size)
+end
+
+-- Tabs are updated at most once per frame, so adding many tabs at once only
+-- creates widgets for the tabs that end up in view
+local function queue_update_tabs(tlist)
+    frame.schedule(tlist.widget, update_tabs, tlist)
+end
+
+local function tablist_nb_page_added_cb(tlist, view, idx)
+    table.insert(data[tlist].views, idx, view)
+    queue_update_tabs(tlist)
+    update_tablist_visibility(tlist)
+end
+
+local function tablist_nb_page_removed_cb(tlist, view)
+    local views = data[tlist].views
+    table.remove(views, lousy_util.table.hasitem(views, view))
+    release_tab(tlist, view)
+    queue_update_tabs(tlist)
     update_tablist_visibility(tlist)
 end
 
@@ -138,16 +226,16 @@ local function tablist_nb_switch_page_cb(tlist, view)
         if prev_tl then prev_tl.current = false end
     end
     local tl = data[tlist].tabs[view]
-    tl.current = true
+    if tl then tl.current = true end
 
     scroll_current_tab_into_view(tlist)
 end
 
 local function tablist_nb_page_reordered_cb(tlist, view, idx)
-    local tl = data[tlist].tabs[view]
-    local old_idx = tl.index
-    data[tlist].box:reorder(tl.widget, idx-1)
-    regenerate_tab_indices(tlist, math.min(old_idx, idx), math.max(old_idx, idx))
+    local views = data[tlist].views
+    table.remove(views, lousy_util.table.hasitem(views, view))
+    table.insert(views, idx, view)
+    queue_update_tabs(tlist)
     scroll_current_tab_into_view(tlist)
 end
 
@@ -161,14 +249,16 @@ local function set_notebook(tlist, nb)
             data[tlist].notebook:remove_signal(signame, func)
         end
         -- Destroy all tabs
-        for _, tl in pairs(data[tlist].tabs) do
-            data[tlist].box:remove(tl.widget)
-            tl:destroy()
+        for view in pairs(data[tlist].tabs) do
+            release_tab(tlist, view)
         end
         assert(#data[tlist].box.children == 0)
         data[tlist].notebook = nil
-        data[tlist].tabs = nil
+        data[tlist].prev_view = nil
     end
+    data[tlist].tabs = setmetatable({}, { __mode = "k" })
+    data[tlist].views = {}
+    data[tlist].order = {}
 
     if nb then
         -- Attach notebook signal handlers
@@ -182,15 +272,13 @@ local function set_notebook(tlist, nb)
             nb:add_signal(signame, func)
         end
         -- Make new tabs
-        data[tlist].tabs = setmetatable({}, { __mode = "k" })
-        local current_view = nb[nb:current()]
-        for _, view in ipairs(nb.children) do
-            tablist_nb_page_added_cb(tlist, view, nb:indexof(view))
-            if view == current_view then
-                tablist_nb_switch_page_cb(tlist, view, nb:indexof(view))
-            end
+        for i, view in ipairs(nb.children) do
+            data[tlist].views[i] = view
         end
+        data[tlist].prev_view = nb[nb:current()]
         data[tlist].notebook = nb
+        queue_update_tabs(tlist)
+        scroll_current_tab_into_view(tlist)
         update_tablist_visibility(tlist)
     end
 end
@@ -213,10 +301,21 @@ function _M.new(notebook, orientation)
         set_notebook = set_notebook,
     }
 
-    local box = widget{type = orientation == "horizontal" and "hbox" or "vbox"}
+    -- Tabs are packed between two spacers, which stand in for the tabs
+    -- before and after them
+    local box_type = orientation == "horizontal" and "hbox" or "vbox"
+    local layout, box = widget{type = box_type}, widget{type = box_type}
+    local before, after = widget{type = "eventbox"}, widget{type = "eventbox"}
     local theme = get_theme()
+    layout.homogeneous = false
+    layout.bg = theme.tab_list_bg
     box.bg = theme.tab_list_bg
-    tlist.widget.child = box
+    before.bg = theme.tab_list_bg
+    after.bg = theme.tab_list_bg
+    layout:pack(before)
+    layout:pack(box, { expand = true, fill = true })
+    layout:pack(after)
+    tlist.widget.child = layout
 
     -- Hide scrollbar on horizontal tablist, since it covers the tabs
     if orientation == "horizontal" then
@@ -226,13 +325,19 @@ function _M.new(notebook, orientation)
     -- Save private widget data
     data[tlist] = {
         box = box,
+        before = before,
+        after = after,
         orientation = orientation,
         visible = true,
+        -- Estimated until a tab is shown
+        tab_size = orientation == "horizontal" and (_M.min_width or 100) or 20,
     }
 
     -- Setup class signals
     signal.setup(tlist)
     tlist.widget:hide()
+    tlist.widget:add_signal("property::scroll", function () queue_update_tabs(tlist) end)
+    tlist.widget:add_signal("resize", function () queue_update_tabs(tlist) end)
 
     -- Setup metatable interface
     setmetatable(tlist, {
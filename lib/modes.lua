@@ -116,11 +116,8 @@ window.add_signal("init", function (w)
                         t[k] = v.history.items
                     end
                 end
-                local f = io.open(luakit.data_dir .. "/command-history", "w")
-                if f then
-                    f:write(lousy.pickle.pickle(t))
-                    f:close()
-                end
+                luakit.save_file_async(luakit.data_dir .. "/command-history",
+                    lousy.pickle.pickle(t))
             end
         end
     end)
@@ -257,6 +254,15 @@ _M.new_mode("lua", [[Execute arbitrary Lua commands within the luakit
 --   activated, of type @ref{bind_action_cb}.
 -- - `options` is a table of bind-time options passed to the `action` callback.
 --
+-- `action` may also be a table with a `func` field holding the callback, and
+-- an optional `desc` field. If it also has a `native` field set to `true`,
+-- key binds for the action are looked up by the window widget itself while no
+-- buffer is pending, which is much cheaper for keys that are held down, like
+-- scrolling keys. Such actions are only passed the bind-time options.
+-- Since `<any>` binds see every key first, they disable native binds for
+-- their mode, unless their action has a `needs_buffer` field set to `true`
+-- to show that it does nothing while no buffer is pending.
+--
 -- @tparam table|string mode The name of the mode, or an array of mode names.
 -- @tparam table binds An array of binds to add to each of the named modes.
 _M.add_binds = function (mode, binds)
@@ -123,14 +123,14 @@ end
 --- Save the proxies list to a file.
 -- @tparam string fd_name Custom proxy storage or `nil` to use default.
 function _M.save(fd_name)
-    local fd = io.open(fd_name or proxies_file, "w")
+    local lines = {}
     for name, address in pairs(proxies) do
         if address ~= "" then
             local status = (active.name == name and '*') or ' '
-            fd:write(string.format("%s %s %s\n", status, name, address))
+            table.insert(lines, string.format("%s %s %s\n", status, name, address))
         end
     end
-    io.close(fd)
+    luakit.save_file_async(fd_name or proxies_file, table.concat(lines))
 end
 
 --- Add a new proxy server to current list.
@@ -58,6 +58,7 @@ function _M.load(fd_name)
     if not qmarks then qmarks = {} end
 
     fd_name = fd_name or quickmarks_file
+    luakit.flush_file_writes(fd_name)
     if not os.exists(fd_name) then return end
 
     for line in io.lines(fd_name) do
@@ -74,12 +75,12 @@ function _M.save(fd_name)
     -- Quickmarks init check
     if not qmarks then _M.load() end
 
-    local fd = io.open(fd_name or quickmarks_file, "w")
+    local lines = {}
     for _, token in ipairs(lousy.util.table.keys(qmarks )) do
         local uris = table.concat(qmarks [token], ", ")
-        fd:write(string.format("%s %s\n", token, uris))
+        table.insert(lines, string.format("%s %s\n", token, uris))
     end
-    io.close(fd)
+    luakit.save_file_async(fd_name or quickmarks_file, table.concat(lines))
 end
 
 --- Return URI related to given key or nil if does not exist.
@@ -35,14 +35,19 @@ local function domain_from_uri(uri)
     return domain or ""
 end
 
+local function send_request(p, _, headers)
+    if not headers.Referer then return end
+    if domain_from_uri(p.uri) ~= domain_from_uri(headers.Referer) then
+        msg.verbose("Removing referer '%s'", headers.Referer)
+        headers.Referer = nil
+    end
+end
+
+-- Only requests which carry a Referer header are of interest
+page.add_request_filter({ headers = { "Referer" } }, send_request)
+
 luakit.add_signal("page-created", function(page)
-    page:add_signal("send-request", function(p, _, headers)
-        if not headers.Referer then return end
-        if domain_from_uri(p.uri) ~= domain_from_uri(headers.Referer) then
-            msg.verbose("Removing referer '%s'", headers.Referer)
-            headers.Referer = nil
-        end
-    end)
+    page:add_signal("send-request", send_request)
 end)
 
 return _M
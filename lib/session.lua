@@ -29,14 +29,47 @@ _M.session_file = luakit.data_dir .. "/session"
 -- @readwrite
 _M.recovery_file = luakit.data_dir .. "/recovery_session"
 
+-- Session files are a header followed by records made with
+-- `luakit.serialize()`: one record per tab holding its (large) session state,
+-- and window layout records. Saves append records for changed tabs and a new
+-- layout; the file is rewritten once enough has been appended.
+local session_magic = "luakit-session-1\n"
+local compact_threshold = 1024*1024
+
+-- Stable per-tab record identifiers
+local tab_ids = setmetatable({}, { __mode = "k" })
+local next_tab_id = 1
+-- Incremented whenever the session state of a tab may have changed
+local tab_versions = setmetatable({}, { __mode = "k" })
+
+-- Per-file log state: serialized tab records, the tab versions they hold,
+-- and the number of bytes appended since the file was last rewritten
+local logs = {}
+
+local function forget_file(file)
+    luakit.flush_file_writes(file)
+    logs[file] = nil
+end
+
+-- The most recently switched-to tab
+local last_switched = setmetatable({}, { __mode = "v" })
+
+local function mark_tab_dirty(view)
+    tab_versions[view] = (tab_versions[view] or 0) + 1
+end
+
 --- Save the current session state to a file.
 --
 -- If no file is specified, the path specified by @ref{session_file} is used.
+-- Only tabs that have changed since the last save to the same file are
+-- written, and the file is written on a background thread.
 --
 -- @tparam[opt] string file The file path in which to save the session state.
 _M.save = function (file)
     if not file then file = _M.session_file end
+    local log = logs[file]
     local state = {}
+    local versions = {}
     local wins = lousy.util.table.values(window.bywidget)
     -- Save tabs from all windows
     for _, w in ipairs(wins) do
@@ -46,12 +79,26 @@ _M.save = function (file)
             if tab.private then
                 table.insert(state[w].open, { private = true })
             else
-                table.insert(state[w].open, {
+                local id = tab_ids[tab]
+                if not id then
+                    id, next_tab_id = next_tab_id, next_tab_id + 1
+                    tab_ids[tab] = id
+                end
+                local item = {
                     ti = ti,
                     current = (current == ti),
                     uri = tab.uri,
-                    session_state = tab.session_state
-                })
+                    title = tab.title,
+                    tab = id,
+                }
+                -- Only fetch the session state of changed tabs; the current
+                -- tab may have been scrolled
+                local version = tab_versions[tab] or 0
+                if not log or log.versions[id] ~= version or current == ti then
+                    item.session_state = tab.session_state
+                    versions[id] = version
+                end
+                table.insert(state[w].open, item)
             end
         end
     end
@@ -71,15 +118,68 @@ _M.save = function (file)
     end
     state = istate
 
-    if #state > 0 then
-        local tempfile = file .. ".new"
-        local fh = io.open(tempfile, "wb")
-        fh:write(pickle.pickle(state))
-        io.close(fh)
-        os.rename(tempfile, file)
-    else
+    if #state == 0 then
+        forget_file(file)
         os.remove(file)
+        return
     end
+
+    -- Split changed tab session states out into their own records
+    local records, changed = {}, {}
+    for _, ws in ipairs(state) do
+        for _, item in ipairs(ws.open) do
+            local id = item.tab
+            if versions[id] then
+                records[id] = luakit.serialize({ tab = id, session_state = item.session_state })
+                table.insert(changed, records[id])
+            else
+                records[id] = log.records[id]
+            end
+            item.session_state = nil
+        end
+    end
+    local layout = luakit.serialize({ windows = state })
+
+    if not log or log.appended > compact_threshold then
+        local parts = { session_magic }
+        for _, record in pairs(records) do table.insert(parts, record) end
+        table.insert(parts, layout)
+        luakit.save_file_async(file, table.concat(parts), 0)
+        log = { versions = {}, appended = 0 }
+        logs[file] = log
+    else
+        table.insert(changed, layout)
+        local data = table.concat(changed)
+        luakit.append_file_async(file, data, 0)
+        log.appended = log.appended + #data
+    end
+
+    -- Only keep records of tabs that are still open
+    log.records = records
+    for id, version in pairs(versions) do log.versions[id] = version end
+    for id in pairs(log.versions) do
+        if not records[id] then log.versions[id] = nil end
+    end
+end
+
+-- Decode a binary session file into the same format as pickled sessions
+local function load_records(data)
+    local records = luakit.deserialize(data:sub(#session_magic + 1))
+    local tabs, windows = {}, {}
+    for _, record in ipairs(records) do
+        if record.tab then
+            tabs[record.tab] = record
+        elseif record.windows then
+            windows = record.windows
+        end
+    end
+    for _, win in ipairs(windows) do
+        for _, item in ipairs(win.open) do
+            item.session_state = (tabs[item.tab] or {}).session_state
+            item.tab = nil
+        end
+    end
+    return windows
 end
 
 --- Load session state from a file, and optionally delete it.
@@ -97,15 +197,28 @@ end
 -- @tparam[opt] string file The file path from which to load the session state.
 _M.load = function (delete, file)
     if not file then file = _M.session_file end
+    luakit.flush_file_writes(file)
     if not os.exists(file) then return {} end
 
     -- Read file
     local fh = io.open(file, "rb")
-    local state = pickle.unpickle(fh:read("*all"))
+    local data = fh:read("*all")
     io.close(fh)
+    local state
+    if data:sub(1, #session_magic) == session_magic then
+        state = load_records(data)
+    else
+        -- Sessions saved by older versions of luakit
+        state = pickle.unpickle(data)
+    end
     -- Backup file on idle (i.e. only if config loads successfully)
     if delete ~= false and file ~= _M.recovery_file then
-        luakit.idle_add(function() os.rename(file, _M.recovery_file) end)
+        luakit.idle_add(function()
+            forget_file(file)
+            forget_file(_M.recovery_file)
+            os.rename(file, _M.recovery_file)
+            return false
+        end)
     end
 
     return state
@@ -127,11 +240,14 @@ local restore_file = function (file, delete)
                 w = window.new({settings.get_setting("window.new_tab_page")})
                 v = w.view
             else
-                v = w:new_tab(settings.get_setting("window.new_tab_page"), { switch = item.current })
+                -- Only create the WebKit view of a tab once it is first shown
+                v = w:new_tab(nil, { switch = item.current, placeholder = true, no_initial_url = true })
             end
             -- Block the tab load, then set its location
             webview.modify_load_block(v, "session-restore", true)
-            webview.set_location(v, { session_state = item.session_state, uri = item.uri })
+            webview.set_location(v, {
+                session_state = item.session_state, uri = item.uri, title = item.title,
+            })
             local function unblock(vv)
                 webview.modify_load_block(vv, "session-restore", false)
                 vv:remove_signal("switched-page", unblock)
@@ -186,7 +302,8 @@ settings.add_signal("setting-changed", function (e)
 end)
 
 recovery_save_timer = timer{
-    interval = settings.get_setting("session.recovery_save_interval")*1000
+    interval = settings.get_setting("session.recovery_save_interval")*1000,
+    slack = 5000,
 }
 
 -- Save current window session helper
@@ -215,6 +332,9 @@ window.add_signal("init", function (w)
         -- Hack: should add a luakit shutdown hook...
         local num_windows = #lousy.util.table.values(window.bywidget)
         -- Remove the recovery session on a successful exit
+        if num_windows == 0 then
+            forget_file(_M.recovery_file)
+        end
         if num_windows == 0 and os.exists(_M.recovery_file) then
             os.remove(_M.recovery_file)
         end
@@ -237,13 +357,18 @@ end)
 
 webview.add_signal("init", function (view)
     -- Save session state after page navigation
-    view:add_signal("load-status", function (_, status)
+    view:add_signal("load-status", function (v, status)
+        mark_tab_dirty(v)
         if status == "committed" then
             start_timeout()
         end
     end)
     -- Save session state after switching page (session includes current tab)
-    view:add_signal("switched-page", function ()
+    view:add_signal("switched-page", function (v)
+        -- The tab being switched away from may have been scrolled
+        local prev = last_switched.view
+        if prev and prev ~= v then mark_tab_dirty(prev) end
+        last_switched.view = v
         start_timeout()
     end)
 end)
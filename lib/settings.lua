@@ -22,6 +22,14 @@ local S = {
     view_overrides = setmetatable({}, { __mode = "k" }),
 }
 
+-- Resolved settings, keyed by the list of domains of a URI that have
+-- domain-specific settings, so that the number of entries is bounded by the
+-- configured domains rather than the visited ones; cleared whenever any
+-- setting changes
+local profiles = {}
+local function invalidate_profiles() profiles = {} end
+_M.add_signal("setting-changed", invalidate_profiles)
+
 local persisted_settings
 do
     local ok
@@ -42,6 +50,11 @@ do
     end
 end
 
+local function save_persisted_settings ()
+    luakit.save_file_async(luakit.data_dir .. "/settings",
+        lousy.pickle.pickle(persisted_settings))
+end
+
 local function validate_settings_path (k)
     assert(type(k) == "string", "invalid settings path type: " .. type(k))
     local parts = lousy.util.string.split(k, "%.")
@@ -122,6 +135,7 @@ _M.register_settings = function (list)
     end
 
     settings_groups = nil
+    invalidate_profiles()
 end
 
 local function setting_validate_new_kv_pair (meta, k, v)
@@ -194,9 +208,7 @@ local function S_set(domain, key, val, persist)
 
     if persist then
         set(persisted_settings, domain, key, val)
-        local fh = io.open(luakit.data_dir .. "/settings", "wb")
-        fh:write(lousy.pickle.pickle(persisted_settings))
-        io.close(fh)
+        save_persisted_settings()
     end
 
     S.source[domain] = S.source[domain] or {}
@@ -223,9 +235,7 @@ local function S_set_table(domain, sn, key, val, persist)
     if persist then
         local tbl = persisted_settings[domain][sn]
         tbl[key] = val
-        local fh = io.open(luakit.data_dir .. "/settings", "wb")
-        fh:write(lousy.pickle.pickle(persisted_settings))
-        io.close(fh)
+        save_persisted_settings()
     end
 
     local source = S.source[domain][sn]
@@ -261,6 +271,7 @@ local function S_overwrite_table(domain, k, v)
     tree[k] = tbl
     -- TODO: add validation for tables
     for kk, vv in pairs(v) do tbl[kk] = vv end
+    invalidate_profiles()
 end
 
 local uri_domain_cache = {}
@@ -297,6 +308,56 @@ _M.get_setting_for_view = function (view, key)
     return S.domain[""][key]
 end
 
+--- Retrieve the values of all settings for a webview.
+--
+-- This is equivalent to calling `get_setting_for_view()` for every registered
+-- setting, but the domain-specific part of the result is cached and shared by
+-- all views whose URIs match the same domain-specific settings, until any
+-- setting is changed. The returned table must not be modified.
+--
+-- @tparam widget view The webview.
+-- @treturn table The setting values, keyed by setting name; and a table of
+-- the matching domains, keyed by setting name.
+_M.get_settings_for_view = function (view)
+    assert(type(view) == "widget" and view.type == "webview")
+    local uri = view.uri
+    if uri ~= uri_domain_cache.uri then
+        uri_domain_cache.uri = uri
+        uri_domain_cache.domains = lousy.uri.domains_from_uri(uri)
+    end
+    local domains = {}
+    for _, domain in ipairs(uri_domain_cache.domains) do
+        if S.domain[domain] then table.insert(domains, domain) end
+    end
+    local profile_key = table.concat(domains, " ")
+
+    local profile = profiles[profile_key]
+    if not profile then
+        local values, matches = {}, {}
+        for key in pairs(settings_list) do
+            values[key] = S.domain[""][key]
+        end
+        -- Apply the least specific domain first
+        for i = #domains, 1, -1 do
+            local domain = domains[i]
+            for key, value in pairs(S.domain[domain]) do
+                values[key], matches[key] = value, domain
+            end
+        end
+        profile = { values = values, matches = matches }
+        profiles[profile_key] = profile
+    end
+
+    -- view-specific overrides
+    local tree = S.view_overrides[view]
+    if not tree or not next(tree) then
+        return profile.values, profile.matches
+    end
+    local values = lousy.util.table.clone(profile.values)
+    for key, value in pairs(tree) do values[key] = value end
+    return values, profile.matches
+end
+
 --- Add or remove a view-specific override for a setting.
 -- Passing `nil` as the `value` will clear any override.
 --
@@ -10,7 +10,6 @@
 local chrome = require "chrome"
 local modes = require "modes"
 local settings = require "settings"
-local markdown = require "markdown"
 local lousy = require "lousy"
 
 local _M = {}
@@ -251,7 +250,7 @@ local build_settings_entry_html = function (meta)
     desc = desc:gsub("^\n*", ""):gsub("[\n ]+$","")
     local fl = #(desc:match("^( +)") or "\n") - 1
     desc = ("\n" .. desc):gsub("\n" .. string.rep(" ", fl), "\n"):sub(2)
-    meta.desc = markdown(desc)
+    meta.desc = require("markdown")(desc)
 
     local disabled_attr = (meta.src ~= "persisted" and meta.src ~= "default") and "disabled" or ""
 
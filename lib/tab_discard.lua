@@ -0,0 +1,181 @@
+--- Discard background tabs to save memory.
+--
+-- Every open tab keeps a WebKit view, and the memory of its web process,
+-- alive. This module tracks when each tab was last active, and discards
+-- background tabs that have been idle for longer than
+-- `tab_discard.idle_timeout`, as well as the least recently active tabs
+-- while web processes use more memory than `tab_discard.memory_budget`.
+--
+-- A discarded tab keeps its session state, title and place in the tab bar,
+-- and is transparently reloaded when it is next shown.
+--
+-- Current, private, loading and audio-playing tabs are never discarded.
+--
+-- @module tab_discard
+
+local window = require("window")
+local webview = require("webview")
+local settings = require("settings")
+local lousy = require("lousy")
+
+local _M = {}
+
+lousy.signal.setup(_M, true)
+
+-- Time at which each tab was last seen as the current tab
+local last_active = setmetatable({}, { __mode = "k" })
+-- Tabs discarded by this module that have not been shown since
+local discarded = setmetatable({}, { __mode = "k" })
+
+settings.register_settings({
+    ["tab_discard.idle_timeout"] = {
+        type = "number",
+        default = 0,
+        validator = function (v) return tonumber(v) >= 0 end,
+        desc = [[
+            The time in minutes after which background tabs are discarded, or
+            `0` to not discard idle tabs.
+        ]],
+    },
+    ["tab_discard.memory_budget"] = {
+        type = "number",
+        default = 0,
+        validator = function (v) return tonumber(v) >= 0 end,
+        desc = [[
+            The memory in MiB that web processes may use before the least
+            recently active background tabs are discarded, or `0` for no
+            limit.
+        ]],
+    },
+})
+
+-- How often tabs are checked, in milliseconds
+local check_interval = 30000
+
+webview.add_signal("init", function (view)
+    last_active[view] = os.time()
+    view:add_signal("switched-page", function (v)
+        last_active[v] = os.time()
+    end)
+    view:add_signal("property::placeholder", function (v)
+        if not v.placeholder then discarded[v] = nil end
+    end)
+end)
+
+-- Resident memory of a process, in bytes
+local function process_rss(pid)
+    local f = io.open("/proc/" .. pid .. "/status")
+    if not f then return 0 end
+    local status = f:read("*a")
+    f:close()
+    return (tonumber(status:match("VmRSS:%s*(%d+)")) or 0) * 1024
+end
+
+-- Background tabs that may be discarded, least recently active first
+local function candidates()
+    local now, views = os.time(), {}
+    for _, w in pairs(window.bywidget) do
+        local current = w.view
+        if current then last_active[current] = now end
+        for _, v in ipairs(w.tabs.children) do
+            if v ~= current and not v.placeholder and not v.private
+                and not v.is_loading and not v.is_playing_audio and not v.inspector then
+                table.insert(views, v)
+            end
+        end
+    end
+    table.sort(views, function (a, b)
+        return (last_active[a] or now) < (last_active[b] or now)
+    end)
+    return views
+end
+
+--- Discard a background tab.
+--
+-- The WebKit view of the tab is destroyed; its session state and title are
+-- kept, and the tab is reloaded when it is next shown. Tabs that are shown,
+-- or already discarded, are not discarded.
+--
+-- @tparam widget view The webview of the tab to discard.
+-- @treturn boolean `true` if the tab was discarded.
+function _M.discard(view)
+    assert(type(view) == "widget" and view.type == "webview")
+    if not view:discard() then return false end
+    discarded[view] = true
+    msg.verbose("discarded %s", view.uri)
+    _M.emit_signal("discard", view)
+    return true
+end
+
+--- Discard background tabs that are idle or over the memory budget.
+--
+-- This is done periodically, but can be called to discard tabs immediately.
+--
+-- @treturn number The number of tabs that were discarded.
+function _M.check()
+    local timeout = settings.get_setting("tab_discard.idle_timeout") * 60
+    local budget = settings.get_setting("tab_discard.memory_budget") * 1024 * 1024
+    if timeout == 0 and budget == 0 then return 0 end
+
+    local n, now, keep = 0, os.time(), {}
+    for _, v in ipairs(candidates()) do
+        if timeout > 0 and now - (last_active[v] or now) >= timeout then
+            if _M.discard(v) then n = n + 1 end
+        else
+            table.insert(keep, v)
+        end
+    end
+    if budget == 0 then return n end
+
+    -- Memory of a web process is freed once all its views are discarded
+    local procs, total = {}, 0
+    for _, w in pairs(window.bywidget) do
+        for _, v in ipairs(w.tabs.children) do
+            local pid = not v.placeholder and v.web_process_id
+            if pid and pid ~= 0 then
+                local proc = procs[pid]
+                if not proc then
+                    proc = { rss = process_rss(pid), views = 0 }
+                    procs[pid] = proc
+                    total = total + proc.rss
+                end
+                proc.views = proc.views + 1
+            end
+        end
+    end
+    for _, v in ipairs(keep) do
+        if total <= budget then break end
+        local proc = procs[v.web_process_id]
+        if _M.discard(v) then
+            n = n + 1
+            if proc then
+                proc.views = proc.views - 1
+                if proc.views == 0 then total = total - proc.rss end
+            end
+        end
+    end
+    return n
+end
+
+--- Get the number of live and discarded tabs.
+--
+-- @treturn number The number of tabs with a WebKit view.
+-- @treturn number The number of tabs discarded by this module.
+function _M.counts()
+    local live, dead = 0, 0
+    for _, w in pairs(window.bywidget) do
+        for _, v in ipairs(w.tabs.children) do
+            if not v.placeholder then live = live + 1
+            elseif discarded[v] then dead = dead + 1 end
+        end
+    end
+    return live, dead
+end
+
+local check_timer = timer{ interval = check_interval, slack = check_interval/2 }
+check_timer:add_signal("timeout", function () _M.check() end)
+check_timer:start()
+
+return _M
+
+-- vim: et:sw=4:ts=8:sts=4:tw=80
@@ -31,6 +31,15 @@ tab.add_signal("build", function (tl, view)
 
     local update_favicon = function (v)
         local uri = v.uri or "about:blank"
+        -- Don't create the WebKit view of placeholder tabs
+        if v.placeholder then
+            if v.private then fav:filename("icons/tab-icon-private.png")
+            elseif uri:match("^luakit://") then fav:filename("icons/tab-icon-chrome.png")
+            elseif not fav:set_favicon_for_uri(uri) then
+                fav:filename("icons/tab-icon-page.png")
+            end
+            return
+        end
         local favicon_js = [=[
             favicon = document.evaluate('//link[(@rel="icon") or (@rel="shortcut icon")]/@href',
                 document, null, XPathResult.STRING_TYPE, null).stringValue || '/favicon.ico';
@@ -48,6 +57,7 @@ tab.add_signal("build", function (tl, view)
         end})
     end
     view:add_signal("favicon", update_favicon)
+    view:add_signal("property::placeholder", update_favicon)
     -- luakit:// URIs don't emit favicon signal
     view:add_signal("property::uri", function (v)
         if webview.has_load_block(v) then update_favicon(v) return end
@@ -71,6 +81,7 @@ tab.add_signal("build", function (tl, view)
     tl.widget:add_signal("destroy", function ()
         view:remove_signal("favicon", update_favicon)
         view:remove_signal("property::uri", update_favicon)
+        view:remove_signal("property::placeholder", update_favicon)
         view:remove_signal("property::is_loading", is_loading_cb)
         view:remove_signal("load-status", finished_cb)
     end)
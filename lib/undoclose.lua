@@ -130,11 +130,17 @@ window.methods.undo_close_tab = function (w, index)
         w.tabs:reorder(view, 1)
     end
 
-    -- Emit 'undo-close' after webview init funcs have run
-    view:add_signal("web-extension-loaded", function(v)
+    -- Emit 'undo-close' after webview init funcs have run; a prewarmed
+    -- webview has already loaded its web extension
+    local function undo_close(v)
         v:emit_signal("undo-close")
         reopening[view] = nil
-    end)
+    end
+    if view.web_process_id ~= 0 then
+        undo_close(view)
+    else
+        view:add_signal("web-extension-loaded", undo_close)
+    end
 end
 
 session.add_signal("save", function (state)
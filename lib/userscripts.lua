@@ -8,6 +8,14 @@
 -- - Userscript files should be placed in the `scripts` sub-directory of the
 --   luakit data directory, and must have a filename ending in `.user.js`.
 --
+-- # Scope
+--
+-- As in Greasemonkey, each userscript runs as the body of a function, not as
+-- a top-level script. Variables and functions declared at the top level of a
+-- userscript are local to it and do not become properties of `window`; to
+-- share a value with the page or other scripts, assign it to `window`
+-- explicitly (e.g. `window.myValue = 1`).
+--
 -- @module userscripts
 -- @copyright 2011 Constantin Schomburg <me@xconstruct.net>
 -- @copyright 2010 Fabian Streitel <karottenreibe@gmail.com>
@@ -40,9 +48,7 @@ end
 local function db_set(file, enabled)
     assert(file)
     if enabled then db[file] = nil else db[file] = false end
-    local fh = io.open(luakit.data_dir .. "/scripts/scripts", "wb")
-    fh:write(lousy.pickle.pickle(db))
-    io.close(fh)
+    luakit.save_file_async(luakit.data_dir .. "/scripts/scripts", lousy.pickle.pickle(db))
 end
 
 -- Pure JavaScript implementation of greasemonkey methods commonly used
@@ -149,6 +155,9 @@ local gm_functions = [=[
   }
 ]=]
 
+-- Handle of the precompiled greasemonkey methods
+local gm_handle
+
 --- Stores all the scripts.
 local scripts = {}
 
@@ -172,10 +181,19 @@ local prototype = {
     run = function (s, view)
         -- Load common greasemonkey methods
         if not lstate[view].gmloaded then
-            view:eval_js(gm_functions, { no_return = true })
+            if not gm_handle then
+                gm_handle = luakit.register_js(gm_functions,
+                    { source = "userscripts.lua" })
+            end
+            view:eval_js(gm_handle, { source = "userscripts.lua", no_return = true })
             lstate[view].gmloaded = true
         end
-        view:eval_js(s.js, { source = s.file, no_return = true, callback =
+        -- Userscripts are compiled once per page, greasemonkey-style, as
+        -- the body of a function
+        if not s.handle then
+            s.handle = luakit.register_js(s.js, { source = s.file })
+        end
+        view:eval_js(s.handle, { source = s.file, no_return = true, callback =
         function (_, err)
             for _, w in pairs(window.bywidget) do
                 if w.view == view then
@@ -247,6 +265,9 @@ local function load_js(file)
         script.js = js
         script.file = file
         script.enabled = db_get(file)
+        if scripts[file] and scripts[file].handle then
+            luakit.unregister_js(scripts[file].handle)
+        end
         scripts[file] = setmetatable(script, { __index = prototype })
     else
         msg.warn("invalid userscript header in file: %s", file)
@@ -303,6 +324,9 @@ end
 function _M.del(file)
     if not scripts[file] then return end
     os.remove(file)
+    if scripts[file].handle then
+        luakit.unregister_js(scripts[file].handle)
+    end
     scripts[file] = nil
 end
 
@@ -130,7 +130,7 @@ local init_funcs = {
     create_webview = function (view)
         -- Return a newly created webview in a new tab
         view:add_signal("create-web-view", function (v)
-            local opts = { private = v.private, no_initial_url = true }
+            local opts = { private = v.private, related = true, no_initial_url = true }
             return _M.window(v):new_tab(nil, opts)
         end)
     end,
@@ -280,23 +280,115 @@ do
     end
 end
 
---- Create a new webview instance.
--- @tparam table opts Table of options. Currently only `private` is recognized
--- as a key.
--- @treturn table The newly-created webview widget.
-function _M.new(opts)
-    assert(opts)
-    local view = widget{type = "webview", private = opts.private}
+local function build(opts)
+    local view = widget{type = "webview", private = opts.private, placeholder = opts.placeholder}
 
     webview_state[view] = { blockers = {} }
     wrap_widget_metatable(view)
+    return view
+end
 
+local function init_view(view)
     -- Call webview init functions
     for _, func in pairs(init_funcs) do
         func(view)
     end
     _M.emit_signal("init", view)
+    return view
+end
+
+-- A webview kept ready for the next new webview; it is only initialized once
+-- it is used, so that modules don't treat it as a tab
+local spare, spare_queued
+-- The spare is only used once its empty page has loaded and its web extension
+-- is connected
+local spare_loaded, spare_connected
+-- The session state of the spare before it loaded its empty page
+local spare_state
+
+local function spare_load_status(_, status)
+    if status == "finished" or status == "failed" then spare_loaded = true end
+end
+
+local function spare_extension_loaded()
+    spare_connected = true
+end
 
+local spare_crashed
+
+local function release_spare()
+    local view = spare
+    spare = nil
+    view:remove_signal("crashed", spare_crashed)
+    view:remove_signal("load-status", spare_load_status)
+    view:remove_signal("web-extension-loaded", spare_extension_loaded)
+    return view
+end
+
+spare_crashed = function (view)
+    if view ~= spare then return end
+    release_spare()
+    luakit.idle_add(function () view:destroy() end)
+end
+
+local function build_spare()
+    spare_queued = nil
+    if spare or not settings.get_setting("webview.prewarm") then return end
+    spare = build({})
+    spare_loaded, spare_connected = false, false
+    spare_state = spare.session_state
+    spare:add_signal("crashed", spare_crashed)
+    spare:add_signal("load-status", spare_load_status)
+    spare:add_signal("web-extension-loaded", spare_extension_loaded)
+    -- Loading an empty page starts the web process, so that the web extension
+    -- is connected by the time the spare is used
+    spare.uri = "about:blank"
+end
+
+local function queue_spare()
+    if spare_queued then return end
+    spare_queued = true
+    luakit.idle_add(build_spare)
+end
+
+local function destroy_spare()
+    if not spare then return end
+    local view = release_spare()
+    webview_state[view] = nil
+    view:destroy()
+end
+
+settings.add_signal("setting-changed", function (e)
+    if e.key == "webview.prewarm" and not e.value then
+        destroy_spare()
+    end
+end)
+
+--- Create a new webview instance.
+--
+-- Unless disabled by the `webview.prewarm` setting, a spare webview is built
+-- in the background when idle, and is returned instead of creating a new one
+-- if possible, so that new tabs are ready to load straight away.
+--
+-- @tparam table opts Table of options. The `private` key makes the webview
+-- ephemeral, and the `placeholder` key defers creating the underlying WebKit
+-- view until the webview is first shown or used. The `related` key must be
+-- set for webviews returned from the `create-web-view` signal.
+-- @treturn table The newly-created webview widget.
+function _M.new(opts)
+    assert(opts)
+    if opts.private or opts.placeholder or opts.related
+        or not (spare and spare_loaded and spare_connected) then
+        if not opts.related then queue_spare() end
+        return init_view(build(opts))
+    end
+    local view = release_spare()
+    queue_spare()
+    -- Drop the history entry of the empty page
+    view.session_state = spare_state
+    init_view(view)
+    -- The web extension was loaded before the view was initialized
+    view:emit_signal("web-extension-loaded")
     return view
 end
 
@@ -352,7 +444,8 @@ end
 -- place (see @ref{modify_load_block}).
 -- @tparam widget view The view whose location to modify.
 -- @tparam table arg The new location. Can be a URI, a JavaScript URI, or a
--- table with `session_state` and `uri` keys.
+-- table with `session_state` and `uri` keys, and an optional `title` to show
+-- for a placeholder until its page is loaded.
 function _M.set_location(view, arg)
     assert(type(view) == "widget" and view.type == "webview")
     assert(type(arg) == "string" or type(arg) == "table")
@@ -372,6 +465,8 @@ function _M.set_location(view, arg)
     if type(arg) == "string" then arg = { uri = arg } end
     assert(arg.uri or arg.session_state)
 
+    if arg.title and view.placeholder then view.title = arg.title end
+
     local ws = webview_state[view]
     if next(ws.blockers) then
         ws.queued_location = arg
@@ -381,7 +476,8 @@ function _M.set_location(view, arg)
 
     if arg.session_state then
         view.session_state = arg.session_state
-        if view.uri == "about:blank" and arg.uri then
+        -- Placeholders only show the uri until their session state is restored
+        if (view.uri == "about:blank" or view.placeholder) and arg.uri then
             view.uri = arg.uri
         end
     else
@@ -713,6 +809,15 @@ local webview_settings = {
 }
 settings.register_settings(webview_settings)
 settings.register_settings({
+    ["webview.prewarm"] = {
+        type = "boolean",
+        default = true,
+        desc = [=[
+            Whether to keep a spare webview ready in the background, so that
+            new tabs and windows can start loading without waiting for a web
+            process to start.
+        ]=],
+    },
     ["webview.user_agent"] = {
         type = "string",
         default = "",
@@ -724,6 +829,25 @@ settings.register_settings({
     },
 })
 
+-- Webview properties for a table of resolved settings; cached, since
+-- settings tables are shared between views showing the same domain
+local props_cache = setmetatable({}, { __mode = "k" })
+local function settings_to_props(values)
+    local props = props_cache[values]
+    if props then return props end
+    props = {}
+    for k in pairs(webview_settings) do
+        local v = values[k]
+        if v ~= nil then
+            k = k:sub(9) -- Strip off prefix
+            if k == "zoom_level" then v = v/100.0 end
+            props[k] = v
+        end
+    end
+    props_cache[values] = props
+    return props
+end
+
 _M.add_signal("init", function (view)
     local set = function (wv, k, v, match)
         -- hand through webview.-prefixed settings
@@ -737,10 +861,10 @@ _M.add_signal("init", function (view)
         end
     end
     local set_all = function (vv)
-        for k in pairs(webview_settings) do
-            local v, match = settings.get_setting_for_view(vv, k)
-            set(vv, k, v, match)
-        end
+        -- Only properties that differ from the previous page are set
+        local values = settings.get_settings_for_view(vv)
+        local n = vv:set_settings(settings_to_props(values))
+        msg.verbose("changed %d settings for %s", n, vv.uri)
     end
     -- Set domain-specific values on page load
     view:add_signal("load-status", function (v, status)
@@ -298,12 +298,48 @@ _M.methods = {
 
         local caught, newbuf = lousy.bind.hit(w, w.binds, mods, key, opts)
         if w.win then -- Check binding didn't cause window to exit
+            local had_buffer = w.buffer ~= nil
             w.buffer = newbuf
             w:update_buf()
+            if had_buffer ~= (newbuf ~= nil) then w:update_native_binds() end
         end
         return caught
     end,
 
+    -- Let the window widget run binds with native actions itself while no
+    -- buffer is pending; see `widget:set_native_binds()`.
+    update_native_binds = function (w)
+        if not w.win then return end
+        if w.buffer then
+            w.win:set_native_binds(nil)
+            return
+        end
+        if not w.native_binds then
+            w.native_binds = {}
+            for _, m in ipairs(w.binds) do
+                local b, a, o = unpack(m)
+                -- <any> binds see every key first, unless they only act on
+                -- a pending buffer
+                if b == "<any>" and not a.needs_buffer then
+                    w.native_binds = {}
+                    break
+                end
+                -- Only the first bind for each key is ever run
+                if b ~= "<any>" and b:match("^<.+>$") and w.native_binds[b] == nil then
+                    w.native_binds[b] = a.native and function ()
+                        return a.func(w, o)
+                    end or false
+                end
+            end
+            for b, func in pairs(w.native_binds) do
+                if not func then w.native_binds[b] = nil end
+            end
+        end
+        -- Synthetic keys only run binds if not acted on by the page
+        w.win:set_native_binds(w.native_binds,
+            not settings.get_setting("window.act_on_synthetic_keys"))
+    end,
+
     -- Wrapper around the bind plugin's match_cmd method
     match_cmd = function (w, buffer)
         local get_mode = require("modes").get_mode
@@ -435,6 +471,8 @@ _M.methods = {
         -- Clear & hide buffer
         w.buffer = nil
         w:update_buf()
+        w.native_binds = nil
+        w:update_native_binds()
     end,
 
     new_tab = function (w, arg, opts)
@@ -467,7 +505,11 @@ _M.methods = {
 
         if not view then
             -- Make new webview widget
-            view = webview.new({ private = opts.private })
+            view = webview.new({
+                private = opts.private,
+                placeholder = opts.placeholder,
+                related = opts.related,
+            })
             if not arg and not opts.no_initial_url then
                 view.uri = settings.get_setting("window.new_tab_page")
             end
@@ -909,6 +951,12 @@ settings.migrate_global("window.load_etc_hosts", "load_etc_hosts")
 settings.migrate_global("window.check_filepath", "check_filepath")
 settings.migrate_global("window.max_title_len", "max_title_len")
 
+settings.add_signal("setting-changed", function (e)
+    if e.key == "window.act_on_synthetic_keys" then
+        for _, w in pairs(_M.bywidget) do w:update_native_binds() end
+    end
+end)
+
 local globals = package.loaded.globals
 if globals then
     settings.window.search_engines = globals.search_engines
@@ -23,6 +23,8 @@
 #include "luah.h"
 #include "log.h"
 #include "common/luah.h"
+#include "common/luacache.h"
+#include "common/trace.h"
 #include "common/luautil.h"
 #include "common/luayield.h"
 
@@ -33,6 +35,7 @@
 #include "clib/sqlite3.h"
 #include "clib/soup.h"
 #include "clib/unique.h"
+#include "clib/url_index.h"
 #include "clib/widget.h"
 #include "clib/xdg.h"
 #include "clib/stylesheet.h"
@@ -48,35 +51,79 @@
 #include <gtk/gtk.h>
 #include <stdlib.h>
 
+/* Registry keys of the caches used by luaH_modifier_table_push() and
+ * luaH_keystr_push() */
+#define LUAKIT_MODIFIER_TABLES_REGISTRY_KEY "luakit.modifier_tables"
+#define LUAKIT_KEY_NAMES_REGISTRY_KEY "luakit.key_names"
+
+/* Push a table from the registry, creating it if it doesn't exist */
+static void
+luaH_registry_table_push(lua_State *L, const gchar *key)
+{
+    lua_pushstring(L, key);
+    lua_rawget(L, LUA_REGISTRYINDEX);
+    if (lua_isnil(L, -1)) {
+        lua_pop(L, 1);
+        lua_newtable(L);
+        lua_pushstring(L, key);
+        lua_pushvalue(L, -2);
+        lua_rawset(L, LUA_REGISTRYINDEX);
+    }
+}
+
+/* Push the modifiers table for a modifier mask. Tables are created once per
+ * combination of modifiers and shared by all events after that, so they must
+ * not be modified. */
 void
 luaH_modifier_table_push(lua_State *L, guint state) {
+    guint mask = state & (GDK_SHIFT_MASK | GDK_LOCK_MASK | GDK_CONTROL_MASK
+            | GDK_MOD1_MASK | GDK_MOD2_MASK | GDK_MOD3_MASK | GDK_MOD4_MASK | GDK_MOD5_MASK);
+
+    luaH_registry_table_push(L, LUAKIT_MODIFIER_TABLES_REGISTRY_KEY);
+    lua_rawgeti(L, -1, mask + 1);
+    if (!lua_isnil(L, -1)) {
+        lua_remove(L, -2);
+        return;
+    }
+    lua_pop(L, 1);
+
     gint i = 1;
     lua_newtable(L);
-    if (state & GDK_MODIFIER_MASK) {
 
 #define MODKEY(key, name)           \
-    if (state & GDK_##key##_MASK) { \
+    if (mask & GDK_##key##_MASK) {  \
         lua_pushstring(L, name);    \
         lua_rawseti(L, -2, i++);    \
     }
 
-        MODKEY(SHIFT, "Shift");
-        MODKEY(LOCK, "Lock");
-        MODKEY(CONTROL, "Control");
-        MODKEY(MOD1, "Mod1");
-        MODKEY(MOD2, "Mod2");
-        MODKEY(MOD3, "Mod3");
-        MODKEY(MOD4, "Mod4");
-        MODKEY(MOD5, "Mod5");
+    MODKEY(SHIFT, "Shift");
+    MODKEY(LOCK, "Lock");
+    MODKEY(CONTROL, "Control");
+    MODKEY(MOD1, "Mod1");
+    MODKEY(MOD2, "Mod2");
+    MODKEY(MOD3, "Mod3");
+    MODKEY(MOD4, "Mod4");
+    MODKEY(MOD5, "Mod5");
 
 #undef MODKEY
 
-    }
+    lua_pushvalue(L, -1);
+    lua_rawseti(L, -3, mask + 1);
+    lua_remove(L, -2);
 }
 
+/* Push the name of a key; names are looked up once per keyval */
 void
 luaH_keystr_push(lua_State *L, guint keyval)
 {
+    luaH_registry_table_push(L, LUAKIT_KEY_NAMES_REGISTRY_KEY);
+    lua_rawgeti(L, -1, keyval);
+    if (!lua_isnil(L, -1)) {
+        lua_remove(L, -2);
+        return;
+    }
+    lua_pop(L, 1);
+
     gchar ucs[7];
     guint ulen;
     guint32 ukval = gdk_keyval_to_unicode(keyval);
@@ -90,6 +137,10 @@ luaH_keystr_push(lua_State *L, guint keyval)
     /* sent keysym for non-printable characters */
     else
         lua_pushstring(L, gdk_keyval_name(keyval));
+
+    lua_pushvalue(L, -1);
+    lua_rawseti(L, -3, keyval);
+    lua_remove(L, -2);
 }
 
 void
@@ -129,6 +180,9 @@ luaH_init(gchar ** uris)
     /* Export sqlite3 */
     sqlite3_class_setup(L);
 
+    /* Export url_index */
+    url_index_lib_setup(L);
+
     /* Export timer */
     timer_class_setup(L);
 
@@ -156,6 +210,12 @@ luaH_init(gchar ** uris)
     /* add Lua search paths */
     luaH_add_paths(L, globalconf.config_dir);
 
+    /* load modules from cached bytecode when possible */
+    luaH_bytecode_cache_setup(L, globalconf.cache_dir, "bytecode");
+
+    /* record module load times with --profile-startup */
+    luaH_trace_setup(L);
+
     /* push a table of the startup uris */
     const gchar *uri;
     lua_newtable(L);
@@ -173,7 +233,7 @@ luaH_loadrc(const gchar *confpath, gboolean run)
 
     lua_State *L = common.L;
 
-    if (luaL_loadfile(L, confpath)) {
+    if (luaH_loadfile(L, confpath)) {
         error("Error loading rc: %s", lua_tostring(L, -1));
         return FALSE;
     }
@@ -18,11 +18,14 @@
  *
  */
 
+#include "clib/luakit.h"
 #include "common/util.h"
+#include "common/trace.h"
 #include "globalconf.h"
 #include "luah.h"
 #include "ipc.h"
 #include "log.h"
+#include "remote.h"
 #include "web_context.h"
 
 #include <errno.h>
@@ -105,6 +108,7 @@ parseopts(int *argc, gchar *argv[], gboolean **nonblock)
         { "uri",      'u', 0, G_OPTION_ARG_STRING_ARRAY, &uris,                "uri(s) to load at startup", "URI"  },
         { "verbose",  'v', 0, G_OPTION_ARG_NONE,         &verbose,             "print verbose output",      NULL   },
         { "log",      'l', 0, G_OPTION_ARG_STRING,       &log_lvl,             "specify precise log level", "NAME" },
+        { "profile-startup", 0, 0, G_OPTION_ARG_FILENAME, &globalconf.trace_path, "write a startup trace to FILE", "FILE" },
         { "version",  'V', 0, G_OPTION_ARG_NONE,         &version_only,        "print version and exit",    NULL   },
         { NULL,       0,   0, 0,                         NULL,                 NULL,                        NULL   },
     };
@@ -205,6 +209,7 @@ main(gint argc, gchar *argv[])
 {
     gboolean *nonblock = NULL;
     globalconf.starttime = l_time();
+    gint64 start = trace_now();
 
     log_init();
 
@@ -217,6 +222,15 @@ main(gint argc, gchar *argv[])
     /* parse command line opts and get uris to load */
     gchar **uris = parseopts(&argc, argv, &nonblock);
 
+    /* hand uris off to a running instance without initializing GTK or Lua */
+    if (!globalconf.nounique && remote_open_uris(REMOTE_DEFAULT_APP_ID, uris))
+        exit(EXIT_SUCCESS);
+
+    /* the trace is written once a window has been drawn and a web
+     * extension has loaded */
+    if (globalconf.trace_path)
+        trace_init("luakit", globalconf.trace_path, 2);
+
     /* hide command line parameters so process lists don't leak (possibly
        confidential) URLs */
     for (gint i = 1; i < argc; i++)
@@ -238,24 +252,41 @@ main(gint argc, gchar *argv[])
         }
     }
 
+    gint64 t = trace_now();
     gtk_init(&argc, &argv);
+    trace_span("startup", "gtk_init", t);
 
 #if GLIB_MAJOR_VERSION == 2 && GLIB_MINOR_VERSION >= 50
     g_log_set_writer_func(glib_log_writer, NULL, NULL);
 #endif
     init_directories();
+    t = trace_now();
     web_context_init();
+    trace_span("startup", "web_context_init", t);
+    t = trace_now();
     ipc_init();
+    trace_span("startup", "ipc_init", t);
+    t = trace_now();
     luaH_init(uris);
+    trace_span("startup", "luaH_init", t);
 
     /* parse and run configuration file */
+    t = trace_now();
     if (!luaH_parserc(globalconf.confpath, TRUE))
         fatal("couldn't find rc file");
+    trace_span("startup", "rc.lua", t);
 
     if (!globalconf.windows->len)
         fatal("no windows spawned by rc file, exiting");
 
+    trace_span("startup", "main", start);
     gtk_main();
+
+    /* Write the startup trace if luakit exits early */
+    trace_finish();
+
+    /* Finish any pending luakit.save_file_async() writes */
+    luakit_lib_flush_file_writes(NULL);
     return EXIT_SUCCESS;
 }
 
@@ -0,0 +1,295 @@
+/*
+ * remote.c - fast hand-off of URIs to a running luakit instance
+ *
+ * Copyright © 2026 luakit developers
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* A primary luakit instance listens on a Unix socket in the user runtime
+ * directory, named after its profile and application id. Secondary instances
+ * connect to it before initializing GTK or Lua, send the URIs to open as a
+ * list of NUL-terminated strings, close their end for writing, and wait for a
+ * single byte acknowledgement, sent once the URIs have been handled. If anything goes wrong, the secondary instance
+ * starts up normally, and hands off its URIs via GApplication instead. */
+
+#include "remote.h"
+#include "globalconf.h"
+#include "log.h"
+#include "common/util.h"
+
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+/* How long a client waits for the primary instance to acknowledge its URIs */
+#define REMOTE_ACK_TIMEOUT 5
+
+typedef struct {
+    remote_open_cb_t cb;
+    gpointer user_data;
+} remote_listener_t;
+
+typedef struct {
+    remote_listener_t *listener;
+    GString *buf;
+} remote_client_t;
+
+/* Path of the socket this instance is listening on, if any */
+static gchar *listen_path;
+
+static gboolean
+build_socket_addr(const gchar *app_id, struct sockaddr_un *addr, gchar **dir)
+{
+    *dir = g_build_filename(g_get_user_runtime_dir(), "luakit", globalconf.profile, NULL);
+    gchar *name = g_strconcat(app_id, ".sock", NULL);
+    gchar *path = g_build_filename(*dir, name, NULL);
+    g_free(name);
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    gboolean ok = strlen(path) < sizeof(addr->sun_path);
+    if (ok)
+        strcpy(addr->sun_path, path);
+    else
+        verbose("remote socket path '%s' is too long", path);
+    g_free(path);
+    return ok;
+}
+
+static gboolean
+send_all(int sock, const gchar *data, gsize len)
+{
+    while (len > 0) {
+        ssize_t n = send(sock, data, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return FALSE;
+        data += n;
+        len -= n;
+    }
+    return TRUE;
+}
+
+/* Convert paths of existing files into file:// URIs, since the primary
+ * instance may have a different working directory */
+static void
+append_uri(GString *payload, const gchar *uri)
+{
+    if (g_file_test(uri, G_FILE_TEST_EXISTS)) {
+        GFile *file = g_file_new_for_path(uri);
+        gchar *path = g_file_get_path(file);
+        g_object_unref(file);
+        g_string_append(payload, "file://");
+        for (gchar *c = path; c && *c; c++) {
+            if (*c == ' ')
+                g_string_append(payload, "%20");
+            else
+                g_string_append_c(payload, *c);
+        }
+        g_free(path);
+    } else
+        g_string_append(payload, uri);
+    g_string_append_c(payload, '\0');
+}
+
+/** Send URIs to the primary instance of the current profile, if there is one.
+ *
+ * \param app_id The application id of the primary instance.
+ * \param uris   The URIs to open; an empty list opens a new window.
+ * \return       TRUE if the primary instance received the URIs, in which
+ *               case this instance should exit.
+ */
+gboolean
+remote_open_uris(const gchar *app_id, gchar **uris)
+{
+    struct sockaddr_un addr;
+    gchar *dir;
+    gboolean ok = build_socket_addr(app_id, &addr, &dir);
+    g_free(dir);
+    if (!ok)
+        return FALSE;
+
+    int sock;
+    if ((sock = socket(AF_UNIX, SOCK_STREAM, 0)) == -1)
+        return FALSE;
+
+    /* Fails if there is no primary instance, or it exited uncleanly */
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        close(sock);
+        return FALSE;
+    }
+
+    GString *payload = g_string_new(NULL);
+    for (gchar **uri = uris; uri && *uri; uri++)
+        append_uri(payload, *uri);
+
+    ok = send_all(sock, payload->str, payload->len) && !shutdown(sock, SHUT_WR);
+    g_string_free(payload, TRUE);
+
+    if (ok) {
+        struct timeval timeout = { .tv_sec = REMOTE_ACK_TIMEOUT };
+        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        gchar ack;
+        ssize_t n;
+        while ((n = recv(sock, &ack, 1, 0)) < 0 && errno == EINTR);
+        ok = n == 1;
+    }
+
+    close(sock);
+    if (ok)
+        verbose("sent %u uri(s) to the primary instance", uris ? g_strv_length(uris) : 0);
+    return ok;
+}
+
+static gboolean
+remote_client_dispatch(remote_client_t *client)
+{
+    GPtrArray *uris = g_ptr_array_new();
+    const gchar *end = client->buf->str + client->buf->len;
+    for (const gchar *uri = client->buf->str; uri < end; uri += strlen(uri) + 1)
+        g_ptr_array_add(uris, (gpointer)uri);
+    g_ptr_array_add(uris, NULL);
+
+    gboolean ok = client->listener->cb((gchar**)uris->pdata, client->listener->user_data);
+    g_ptr_array_free(uris, TRUE);
+    return ok;
+}
+
+static gboolean
+remote_client_recv(GIOChannel *channel, GIOCondition UNUSED(cond), remote_client_t *client)
+{
+    int sock = g_io_channel_unix_get_fd(channel);
+    gchar buf[4096];
+    ssize_t n = read(sock, buf, sizeof(buf));
+
+    if (n < 0 && (errno == EINTR || errno == EAGAIN))
+        return TRUE;
+    if (n > 0) {
+        g_string_append_len(client->buf, buf, n);
+        return TRUE;
+    }
+
+    /* The client has sent everything; a truncated final URI means it
+     * gave up part way through. It is only acknowledged once the URIs have
+     * been handled, so that it can fall back to starting up normally */
+    if (n == 0 && (!client->buf->len || client->buf->str[client->buf->len-1] == '\0')) {
+        if (remote_client_dispatch(client))
+            send_all(sock, "", 1);
+        else
+            verbose("unable to handle remote open request");
+    } else
+        verbose("dropping incomplete remote open request");
+
+    g_io_channel_shutdown(channel, FALSE, NULL);
+    g_io_channel_unref(channel);
+    g_string_free(client->buf, TRUE);
+    g_slice_free(remote_client_t, client);
+    return FALSE;
+}
+
+static gboolean
+remote_accept(GIOChannel *channel, GIOCondition UNUSED(cond), remote_listener_t *listener)
+{
+    int sock = accept(g_io_channel_unix_get_fd(channel), NULL, NULL);
+    if (sock == -1) {
+        if (errno != EINTR && errno != EAGAIN)
+            warn("unable to accept remote connection: %s", strerror(errno));
+        return TRUE;
+    }
+
+    remote_client_t *client = g_slice_new(remote_client_t);
+    client->listener = listener;
+    client->buf = g_string_new(NULL);
+
+    GIOChannel *client_channel = g_io_channel_unix_new(sock);
+    g_io_channel_set_encoding(client_channel, NULL, NULL);
+    g_io_channel_set_buffered(client_channel, FALSE);
+    g_io_add_watch(client_channel, G_IO_IN | G_IO_HUP | G_IO_ERR,
+            (GIOFunc)remote_client_recv, client);
+    return TRUE;
+}
+
+static void
+remote_remove_socket_file(void)
+{
+    if (listen_path)
+        g_unlink(listen_path);
+}
+
+/** Accept URIs from remote clients started with the current profile.
+ *
+ * \param app_id    The application id of this, the primary, instance.
+ * \param cb        The function called with each list of URIs received.
+ * \param user_data Passed to \p cb.
+ */
+void
+remote_listen(const gchar *app_id, remote_open_cb_t cb, gpointer user_data)
+{
+    if (listen_path)
+        return;
+
+    struct sockaddr_un addr;
+    gchar *dir;
+    gboolean ok = build_socket_addr(app_id, &addr, &dir);
+    if (ok && g_mkdir_with_parents(dir, 0700)) {
+        warn("unable to create remote socket directory '%s'", dir);
+        ok = FALSE;
+    }
+    g_free(dir);
+    if (!ok)
+        return;
+
+    int sock;
+    if ((sock = socket(AF_UNIX, SOCK_STREAM, 0)) == -1) {
+        warn("unable to create remote socket: %s", strerror(errno));
+        return;
+    }
+
+    /* This is the primary instance, so any existing socket is stale */
+    unlink(addr.sun_path);
+
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) == -1 || listen(sock, 5) == -1) {
+        warn("unable to listen on remote socket %s: %s", addr.sun_path, strerror(errno));
+        close(sock);
+        return;
+    }
+
+    listen_path = g_strdup(addr.sun_path);
+    atexit(remote_remove_socket_file);
+
+    remote_listener_t *listener = g_slice_new(remote_listener_t);
+    listener->cb = cb;
+    listener->user_data = user_data;
+
+    GIOChannel *channel = g_io_channel_unix_new(sock);
+    g_io_channel_set_encoding(channel, NULL, NULL);
+    g_io_add_watch(channel, G_IO_IN, (GIOFunc)remote_accept, listener);
+    verbose("listening for remote clients on %s", listen_path);
+}
+
+// vim: ft=c:et:sw=4:ts=8:sts=4:tw=80
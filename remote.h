@@ -0,0 +1,38 @@
+/*
+ * remote.h - fast hand-off of URIs to a running luakit instance
+ *
+ * Copyright © 2026 luakit developers
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LUAKIT_REMOTE_H
+#define LUAKIT_REMOTE_H
+
+#include <glib.h>
+
+/** The application id used by the unique_instance module */
+#define REMOTE_DEFAULT_APP_ID "org.luakit"
+
+/** Called by the primary instance with the URIs sent by a remote client;
+ * returns whether they were handled */
+typedef gboolean (*remote_open_cb_t)(gchar **uris, gpointer user_data);
+
+gboolean remote_open_uris(const gchar *app_id, gchar **uris);
+void remote_listen(const gchar *app_id, remote_open_cb_t cb, gpointer user_data);
+
+#endif /* end of include guard: LUAKIT_REMOTE_H */
+
+// vim: ft=c:et:sw=4:ts=8:sts=4:tw=80
@@ -69,6 +69,77 @@ T.test_binds_are_called = function ()
     assert.equal(14, hit_count)
 end
 
+T.test_bind_changes_are_seen_after_hits = function ()
+    local binds = {}
+    local hits = {}
+    local function action (name)
+        return { func = function () table.insert(hits, name) end }
+    end
+
+    lousy.bind.add_bind(binds, "a", action("a"))
+    lousy.bind.add_bind(binds, "gg", action("gg"))
+    lousy.bind.hit(nil, binds, {}, "a", {})
+    lousy.bind.hit(nil, binds, {}, "g", { buffer = "g", enable_buffer = true })
+    assert.same({"a", "gg"}, hits)
+
+    -- Added binds
+    lousy.bind.add_bind(binds, "b", action("b"))
+    lousy.bind.add_bind(binds, "gx", action("gx"))
+    lousy.bind.hit(nil, binds, {}, "b", {})
+    lousy.bind.hit(nil, binds, {}, "x", { buffer = "g", enable_buffer = true })
+    assert.same({"a", "gg", "b", "gx"}, hits)
+
+    -- Removed binds
+    lousy.bind.remove_bind(binds, "a")
+    lousy.bind.remove_bind(binds, "gg")
+    assert.is_false(lousy.bind.hit(nil, binds, {}, "a", {}))
+    local _, buf = lousy.bind.hit(nil, binds, {}, "g", { buffer = "g", enable_buffer = true })
+    assert.is_nil(buf)
+    assert.same({"a", "gg", "b", "gx"}, hits)
+
+    -- Remapped binds
+    lousy.bind.remap_bind(binds, "c", "b")
+    assert.is_false(lousy.bind.hit(nil, binds, {}, "b", {}))
+    lousy.bind.hit(nil, binds, {}, "c", {})
+    assert.same({"a", "gg", "b", "gx", "b"}, hits)
+
+    -- Partial buffer matches, with and without a count
+    _, buf = lousy.bind.hit(nil, binds, {}, "g", { buffer = "", enable_buffer = true })
+    assert.equal("g", buf)
+    _, buf = lousy.bind.hit(nil, binds, {}, "g", { buffer = "3", enable_buffer = true })
+    assert.equal("3g", buf)
+end
+
+T.test_native_binds_run_without_key_press = function ()
+    require "binds"
+    local modes = require "modes"
+    local window = require "window"
+
+    local native_hits = 0
+    modes.add_binds("normal", {
+        { "<F9>", { desc = "Test native bind.", native = true,
+            func = function () native_hits = native_hits + 1 end } },
+    })
+    local w = window.new({"about:blank"})
+    -- Keys are only matched by w:hit() from the key-press signal
+    local key_presses, hit = 0, w.hit
+    w.hit = function (...)
+        key_presses = key_presses + 1
+        return hit(...)
+    end
+
+    -- The [count] <any> bind of normal mode doesn't disable native binds
+    w.win:send_key("F9", {})
+    assert.equal(1, native_hits)
+    assert.equal(0, key_presses)
+
+    -- While a buffer is pending, keys go through the key-press signal
+    w.win:send_key("3", {})
+    assert.equal("3", w.buffer)
+    w.win:send_key("F9", {})
+    assert.equal(2, key_presses)
+end
+
 return T
 
 -- vim: et:sw=4:ts=8:sts=4:tw=80
@@ -117,6 +117,45 @@ T.test_website_data = function ()
     v:destroy()
 end
 
+T.test_serialize = function ()
+    local data = luakit.serialize({ a = 1, b = { "x", true } }, "str")
+    local values, len = luakit.deserialize(data)
+    assert.equal(#data, len)
+    assert.same({ { a = 1, b = { "x", true } }, "str" }, values)
+
+    -- Truncated data is ignored
+    values, len = luakit.deserialize(data:sub(1, -2))
+    assert.same({ { a = 1, b = { "x", true } } }, values)
+    assert.is_true(len < #data)
+    assert.same({}, (luakit.deserialize("garbage")))
+
+    assert.has_error(function () luakit.serialize(print) end)
+    local t = {}
+    t.t = t
+    assert.has_error(function () luakit.serialize(t) end)
+end
+
+T.test_save_file_async = function ()
+    local file = os.tmpname()
+    luakit.save_file_async(file, "foo")
+    luakit.save_file_async(file, "bar")
+    luakit.append_file_async(file, "baz")
+    luakit.flush_file_writes(file)
+    local fh = io.open(file, "rb")
+    assert.equal("barbaz", fh:read("*all"))
+    fh:close()
+    os.remove(file)
+end
+
+T.test_favicon_cache_stats = function ()
+    local stats = luakit.favicon_cache_stats()
+    for _, k in ipairs {"size", "hits", "misses", "evictions", "hit_rate"} do
+        assert.is_number(stats[k], "Missing/invalid stat: "..k)
+    end
+    luakit.clear_favicon_database()
+    assert.equal(0, luakit.favicon_cache_stats().size)
+end
+
 T.test_luakit_install_paths = function ()
     local paths = assert(luakit.install_paths)
     assert.equal(paths.install_dir, luakit.install_path)
@@ -0,0 +1,49 @@
+--- Test timer clib functionality.
+--
+-- @copyright 2026 luakit developers
+
+local assert = require "luassert"
+local test = require "tests.lib"
+
+local T = {}
+
+T.test_timer_properties = function ()
+    local t = timer{ interval = 100, slack = 20 }
+    assert.equal(100, t.interval)
+    assert.equal(20, t.slack)
+    assert.is_false(t.started)
+    assert.equal(0, t.fire_count)
+    assert.equal(0, t.callback_time)
+    assert.has_error(function () t.slack = -1 end)
+end
+
+T.test_timer_fire_count = function ()
+    local t = timer{ interval = 5 }
+    t:add_signal("timeout", function ()
+        if t.fire_count == 3 then t:stop() end
+    end)
+    t:start()
+    test.wait_until(function () return not t.started end)
+    assert.equal(3, t.fire_count)
+    assert.is_true(t.callback_time >= 0)
+end
+
+T.test_timers_coalesce_within_slack = function ()
+    -- b may fire up to 100ms late, so it waits for a
+    local a, b = timer{ interval = 20 }, timer{ interval = 5, slack = 100 }
+    local a_count_seen_by_b
+    a:add_signal("timeout", function () a:stop() end)
+    b:add_signal("timeout", function ()
+        a_count_seen_by_b = a.fire_count
+        b:stop()
+    end)
+    a:start()
+    b:start()
+    test.wait_until(function () return not a.started and not b.started end, 50)
+    assert.equal(1, a_count_seen_by_b)
+    assert.equal(1, b.fire_count)
+end
+
+return T
+
+-- vim: et:sw=4:ts=8:sts=4:tw=80
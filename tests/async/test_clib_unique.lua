@@ -0,0 +1,39 @@
+--- Test unique instance support.
+--
+-- @copyright 2026 luakit developers
+
+local assert = require "luassert"
+local test = require "tests.lib"
+local pickle = require "lousy.pickle"
+local window = require "window"
+
+local T = {}
+
+T.test_remote_uris_emit_message = function ()
+    local unique = assert(luakit.unique, "tests should run without -U")
+    assert.is_false(unique.is_running())
+    window.new({})
+
+    local message
+    unique.add_signal("message", function (m) message = m end)
+
+    -- The secondary instance hands its URIs over the remote socket, and
+    -- only exits successfully once they have been acknowledged
+    local reason, status
+    local execpath = ({string.gsub(luakit.execpath, " ", "\\ ")})[1]
+    luakit.spawn(execpath .. " about:blank", function (r, s)
+        reason, status = r, s
+    end)
+    test.wait_until(function () return reason end, 10, 5000)
+
+    assert.equal("exit", reason)
+    assert.equal(0, status)
+    assert.is_string(message)
+    local cmd, arg = message:match("^(%S+)%s*(.*)")
+    assert.equal("open-uri-set", cmd)
+    assert.same({ "about:blank" }, pickle.unpickle(arg))
+end
+
+return T
+
+-- vim: et:sw=4:ts=8:sts=4:tw=80
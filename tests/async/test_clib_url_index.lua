@@ -0,0 +1,99 @@
+--- Test url_index clib functionality.
+--
+-- @copyright 2026 luakit developers
+
+local assert = require "luassert"
+
+local T = {}
+
+local function uris(results)
+    local ret = {}
+    for i, r in ipairs(results) do ret[i] = r.uri end
+    return ret
+end
+
+T.test_module = function ()
+    assert.is_table(url_index)
+end
+
+T.test_url_index_query_matches_terms_in_order = function ()
+    url_index.add("http://url-index-test.example/alpha", "First Page", 1, os.time())
+    url_index.add("http://url-index-test.example/beta", "Second page", 1, os.time())
+
+    assert.same({"http://url-index-test.example/alpha"},
+        uris(url_index.query("url-index-test alpha")))
+    assert.same({"http://url-index-test.example/beta"},
+        uris(url_index.query("URL-INDEX-TEST second")))
+    assert.same({}, uris(url_index.query("second url-index-test")))
+    assert.equal(2, #url_index.query("url-index-test page"))
+    assert.equal(1, #url_index.query("url-index-test", 1))
+end
+
+T.test_url_index_frecency_order = function ()
+    local now, old = os.time(), os.time() - 365*86400
+    url_index.add("http://url-index-rank.example/old", nil, 10, old)
+    url_index.add("http://url-index-rank.example/recent", nil, 2, now)
+    url_index.add("http://url-index-rank.example/often", nil, 5, now)
+
+    assert.same({
+        "http://url-index-rank.example/often",
+        "http://url-index-rank.example/recent",
+        "http://url-index-rank.example/old",
+    }, uris(url_index.query("url-index-rank")))
+
+    url_index.bookmark("http://url-index-rank.example/recent")
+    assert.equal("http://url-index-rank.example/recent", url_index.query("url-index-rank")[1].uri)
+end
+
+T.test_url_index_remove = function ()
+    url_index.add("http://url-index-remove.example/", "Removed", 1, os.time())
+    url_index.bookmark("http://url-index-bookmark.example/", true, "Bookmarked")
+    assert.equal(1, #url_index.query("url-index-remove"))
+    assert.equal("Bookmarked", url_index.query("url-index-bookmark")[1].title)
+
+    url_index.remove("http://url-index-remove.example/")
+    assert.equal(0, #url_index.query("url-index-remove"))
+    url_index.bookmark("http://url-index-bookmark.example/", false)
+    assert.equal(0, #url_index.query("url-index-bookmark"))
+end
+
+T.test_url_index_title_change_back_matches_once = function ()
+    local uri = "http://url-index-retitle.example/"
+    url_index.add(uri, "Zebrafish", 1, os.time())
+    url_index.add(uri, "Quokka", 1, os.time())
+    url_index.add(uri, "Zebrafish", 1, os.time())
+
+    assert.same({uri}, uris(url_index.query("zebrafish")))
+    assert.same({}, uris(url_index.query("quokka")))
+end
+
+T.test_url_index_clear_keeps_bookmarks = function ()
+    local visited = "http://url-index-clear.example/visited"
+    local bookmarked = "http://url-index-clear.example/bookmarked"
+    url_index.add(visited, "Visited", 1, os.time())
+    url_index.bookmark(bookmarked, true, "Bookmarked")
+
+    url_index.clear()
+    assert.same({bookmarked}, uris(url_index.query("url-index-clear")))
+
+    url_index.add(visited, "Visited", 1, os.time())
+    assert.equal(2, #url_index.query("url-index-clear"))
+end
+
+T.test_url_index_compacts_removed_entries = function ()
+    local function uri(i) return "http://url-index-compact.example/" .. i end
+    local size = url_index.size()
+    for i = 1, 600 do url_index.add(uri(i), nil, 1, os.time()) end
+    assert.equal(size + 600, url_index.size())
+
+    for i = 1, 599 do url_index.remove(uri(i)) end
+    assert.equal(size + 1, url_index.size())
+    assert.same({uri(600)}, uris(url_index.query("url-index-compact")))
+
+    url_index.add(uri(1), nil, 1, os.time())
+    assert.equal(2, #url_index.query("url-index-compact"))
+end
+
+return T
+
+-- vim: et:sw=4:ts=8:sts=4:tw=80
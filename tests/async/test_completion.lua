@@ -4,6 +4,7 @@
 
 local T = {}
 local assert = require("luassert")
+local test = require("tests.lib")
 
 uris = {"about:blank"}
 require "config.rc"
@@ -25,6 +26,107 @@ T.test_leaving_completion_restores_correct_input_text = function ()
     assert.equal(":adbl", input.text)
 end
 
+T.test_completion_rows_follow_input_text = function ()
+    local completion = require "completion"
+
+    w:enter_cmd(":ta")
+    w:set_mode("completion")
+    local nrows = w.menu:nrows()
+
+    completion.update_completions(w, ":tabn", 5)
+    assert.is_true(w.menu:nrows() < nrows)
+    for i = 1, w.menu:nrows() do
+        local row = w.menu:get(i)
+        if not row.title then assert.matches("^:tabn", row.text) end
+    end
+
+    completion.update_completions(w, ":ta", 3)
+    assert.equal(nrows, w.menu:nrows())
+    w:set_mode()
+end
+
+-- Count the queries made to the bookmarks database
+local function count_bookmark_queries(bookmarks)
+    local db, queries = bookmarks.db, {}
+    bookmarks.db = { exec = function (_, sql, args)
+        queries[#queries+1] = args and args[1]
+        return db:exec(sql, args)
+    end }
+    return queries, function () bookmarks.db = db end
+end
+
+-- The URIs shown in the bookmarks group of the completion menu
+local function bookmark_rows()
+    local ret, in_group = {}, false
+    for i = 1, w.menu:nrows() do
+        local row = w.menu:get(i)
+        if row.title then
+            in_group = row[1] == "Bookmarks"
+        elseif in_group then
+            ret[#ret+1] = row[2]
+        end
+    end
+    return ret
+end
+
+local function add_test_bookmarks()
+    local bookmarks = require "bookmarks"
+    test.wait_until(function () return bookmarks.db end)
+    if not bookmarks.db:exec([[ SELECT id FROM bookmarks WHERE title = 'Alpha' ]])[1] then
+        bookmarks.add("http://completion-test.example/alpha", { title = "Alpha" })
+        bookmarks.add("http://completion-test.example/beta", { title = "Beta" })
+    end
+    return bookmarks
+end
+
+T.test_complete_sql_results_are_narrowed_in_memory = function ()
+    local completion = require "completion"
+    local settings = require "settings"
+    local queries, restore = count_bookmark_queries(add_test_bookmarks())
+
+    w:enter_cmd(":open completion-test")
+    w:set_mode("completion")
+    assert.same({ "%completion-test%" }, queries)
+    assert.equal(2, #bookmark_rows())
+
+    -- Both bookmarks were found, so longer input is filtered with like_filter
+    local text = ":open completion-test.example/al"
+    completion.update_completions(w, text, #text)
+    assert.same({ "http://completion-test.example/alpha" }, bookmark_rows())
+    test.delay(settings.get_setting("completion.delay") * 2)
+    assert.equal(1, #queries)
+
+    w:set_mode()
+    restore()
+end
+
+T.test_incomplete_sql_results_are_queried_after_delay = function ()
+    local completion = require "completion"
+    local settings = require "settings"
+    settings.set_setting("completion.max_items", 1)
+    local queries, restore = count_bookmark_queries(add_test_bookmarks())
+
+    w:enter_cmd(":open completion-test")
+    w:set_mode("completion")
+    assert.same({ "%completion-test%" }, queries)
+    assert.same({ "http://completion-test.example/beta" }, bookmark_rows())
+
+    -- Results were truncated, so narrowing them can miss matches: they are
+    -- only shown until the database is queried again
+    local text = ":open completion-test.example/al"
+    completion.update_completions(w, text, #text)
+    assert.equal(1, #queries)
+    assert.same({}, bookmark_rows())
+
+    test.wait_until(function () return #queries == 2 end, 10, 2000)
+    assert.equal("%completion-test.example/al%", queries[2])
+    assert.same({ "http://completion-test.example/alpha" }, bookmark_rows())
+
+    w:set_mode()
+    restore()
+    settings.set_setting("completion.max_items", 25)
+end
+
 return T
 
 -- vim: et:sw=4:ts=8:sts=4:tw=80
@@ -0,0 +1,52 @@
+--- Test cooperative background tasks.
+--
+-- @copyright 2026 luakit developers
+
+local test = require "tests.lib"
+local assert = require "luassert"
+local tasks = require "lousy.tasks"
+
+local T = {}
+
+T.test_tasks_run_by_priority_and_take_turns = function ()
+    local order = {}
+    local function task(name, steps)
+        return function ()
+            for i = 1, steps do
+                table.insert(order, name .. i)
+                tasks.yield()
+            end
+        end
+    end
+
+    tasks.spawn(task("a", 2))
+    tasks.spawn(task("b", 2))
+    tasks.spawn(task("c", 1), 1)
+    assert.same({}, order)
+    test.wait_until(function () return tasks.pending() == 0 end)
+    assert.same({"c1", "a1", "b1", "a2", "b2"}, order)
+end
+
+T.test_cancelled_task_is_not_resumed = function ()
+    local steps = 0
+    local t = tasks.spawn(function ()
+        while true do
+            steps = steps + 1
+            tasks.yield()
+        end
+    end)
+    test.wait_until(function () return steps > 0 end)
+    tasks.cancel(t)
+    local cancelled_at = steps
+    test.delay(20)
+    assert.equal(cancelled_at, steps)
+    assert.equal(0, tasks.pending())
+end
+
+T.test_yield_outside_task_fails = function ()
+    assert.has_error(function () tasks.yield() end)
+end
+
+return T
+
+-- vim: et:sw=4:ts=8:sts=4:tw=80
@@ -0,0 +1,35 @@
+--- Test per-frame widget updates.
+--
+-- @copyright 2026 luakit developers
+
+local test = require "tests.lib"
+local assert = require "luassert"
+local frame = require "lousy.widget.frame"
+
+local T = {}
+
+T.test_updates_are_coalesced = function ()
+    local win = widget{type="window"}
+    win:show()
+
+    local calls = {}
+    local update = function (...) table.insert(calls, {...}) end
+    local coalesced = frame.stats.coalesced
+
+    frame.schedule(win, update, 1)
+    frame.schedule(win, update, 2)
+    assert.same({}, calls)
+    test.wait_until(function () return #calls > 0 end)
+    assert.same({{2}}, calls)
+    assert.equal(coalesced + 1, frame.stats.coalesced)
+
+    frame.schedule(win, update, 3)
+    frame.flush(win)
+    assert.same({{2}, {3}}, calls)
+
+    win:destroy()
+end
+
+return T
+
+-- vim: et:sw=4:ts=8:sts=4:tw=80
@@ -0,0 +1,74 @@
+--- Test the tablist widget with many tabs.
+--
+-- @copyright 2026 luakit developers
+
+local test = require "tests.lib"
+local assert = require "luassert"
+local frame = require "lousy.widget.frame"
+local tablist = require "lousy.widget.tablist"
+
+local T = {}
+
+local function tab_title(i)
+    return string.format("tablist test %03d", i)
+end
+
+-- Check that only the tabs near the viewport have widgets, and that clicking
+-- each of them reports the index of its page; returns the indices
+local function check_tabs(tlist, nb)
+    frame.flush(tlist.widget)
+    local tabs = tlist.widget.child.children[2].children
+    assert.is_true(#tabs > 0)
+
+    local tab_size = tabs[1].height
+    local in_view = math.ceil(tlist.widget.height / tab_size) + 1
+    assert.is_true(#tabs <= in_view + 2 * tablist.overscan)
+
+    local index, indices = nil, {}
+    tlist:add_signal("tab-clicked", function (_, i) index = tonumber(i) end)
+    for _, tabw in ipairs(tabs) do
+        index = nil
+        tabw:emit_signal("button-release", {}, 0)
+        assert.is_number(index)
+        assert.is_truthy(tabw.child.text:find(nb[index].title, 1, true))
+        table.insert(indices, index)
+    end
+    tlist:remove_signals("tab-clicked")
+    return indices
+end
+
+T.test_tablist_only_creates_tabs_in_view = function ()
+    local win, box, nb = widget{type="window"}, widget{type="hbox"}, widget{type="notebook"}
+    local tlist = tablist(nb, "vertical")
+    box:pack(tlist.widget, { fill = true })
+    box:pack(nb, { expand = true, fill = true })
+    win.child = box
+    win:show()
+
+    local n = 500
+    for i = 1, n do
+        local view = widget{type="webview", placeholder=true}
+        view.title = tab_title(i)
+        nb:insert(view)
+    end
+    local tabs = tlist.widget.child.children[2]
+    test.wait_until(function () return #tabs.children > 0 end, 10, 2000)
+    assert.equal(1, check_tabs(tlist, nb)[1])
+
+    -- Moved tabs report their new index
+    nb:reorder(nb[5], 1)
+    nb:reorder(nb[n], 2)
+    check_tabs(tlist, nb)
+    assert.equal(tab_title(5), nb[1].title)
+    assert.equal(tab_title(n), nb[2].title)
+
+    -- Tabs far from the start get widgets once scrolled into view
+    tlist.widget.scroll = { y = tabs.children[1].height * (n - 50) }
+    assert.is_true(math.max(unpack(check_tabs(tlist, nb))) > n - 50)
+
+    win:destroy()
+end
+
+return T
+
+-- vim: et:sw=4:ts=8:sts=4:tw=80
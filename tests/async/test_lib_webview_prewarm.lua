@@ -0,0 +1,43 @@
+--- Tests new tabs created from the spare webview.
+--
+-- @copyright 2026 luakit developers
+
+local T = {}
+local test = require "tests.lib"
+local assert = require("luassert")
+
+uris = {"about:blank"}
+require "config.rc"
+
+local settings = require "settings"
+local adblock = require "adblock"
+local window = require "window"
+local w = assert(select(2, next(window.bywidget)))
+
+T.test_new_tab_from_spare_loads_with_adblock = function ()
+    settings.set_setting("webview.prewarm", true)
+    adblock.enabled = true
+
+    -- Open a tab, so that a spare is built, and let the spare start up
+    w:new_tab("about:blank")
+    test.wait_for_view(w.view)
+    test.delay(1000)
+
+    local uri = test.http_server() .. "hello_world.html"
+    w:new_tab(uri)
+    assert.is_equal(w.tabs:current(), 3)
+    -- Only a spare has its web process already running
+    assert.is_not_equal(w.view.web_process_id, 0)
+    test.wait_for_view(w.view)
+    assert.is_equal(w.view.uri, uri)
+    assert.is_false(w.view.can_go_back)
+
+    -- Restore to initial state
+    w:close_tab()
+    w:close_tab()
+    assert.is_equal(w.tabs:current(), 1)
+end
+
+return T
+
+-- vim: et:sw=4:ts=8:sts=4:tw=80
@@ -37,6 +37,44 @@ T.test_settings = function ()
     assert.equal(settings.on[".com"].foo.bar, nil)
 end
 
+T.test_settings_for_view = function ()
+    settings.register_settings({
+        ["test.view.setting"] = {
+            default = 1,
+            type = "number",
+        },
+    })
+
+    local view = widget{type="webview"}
+    view.uri = "http://www.example.com/"
+
+    settings.on["example.com"].test.view.setting = 2
+    local values, matches = settings.get_settings_for_view(view)
+    assert.equal(values["test.view.setting"], 2)
+    assert.equal(matches["test.view.setting"], "example.com")
+    assert.equal(select(1, settings.get_settings_for_view(view)), values)
+
+    -- Changing a setting invalidates the cached values
+    settings.on[".example.com"].test.view.setting = 3
+    values = settings.get_settings_for_view(view)
+    assert.equal(values["test.view.setting"], 3)
+    assert.equal(values["test.view.setting"], settings.get_setting_for_view(view, "test.view.setting"))
+
+    -- Views on domains without their own settings share one cached profile
+    local a, b = widget{type="webview"}, widget{type="webview"}
+    a.uri, b.uri = "http://a.test/", "http://b.test/"
+    assert.equal(select(1, settings.get_settings_for_view(a)),
+        select(1, settings.get_settings_for_view(b)))
+    a:destroy()
+    b:destroy()
+
+    settings.override_setting_for_view(view, "test.view.setting", 4)
+    values = settings.get_settings_for_view(view)
+    assert.equal(values["test.view.setting"], 4)
+
+    view:destroy()
+end
+
 return T
 
 -- vim: et:sw=4:ts=8:sts=4:tw=80
@@ -25,6 +25,18 @@ T.test_bin_widget_set_child = function ()
     assert.is_nil(bin.child)
 end
 
+T.test_widget_set_native_binds = function ()
+    local win = widget{type="window"}
+    local func = function () end
+    win:set_native_binds({ ["<j>"] = func, ["<control-Down>"] = func, ["<Minus>"] = func })
+    win:set_native_binds({ ["<shift-j>"] = func })
+    win:set_native_binds(nil)
+    win:set_native_binds()
+    assert.has_error(function () win:set_native_binds("<j>") end)
+    assert.has_error(function () win:set_native_binds({ ["<j>"] = true }) end)
+    win:destroy()
+end
+
 T.test_webview_widget_privacy = function ()
     local v = widget{type="webview"}
     assert.is_false(v.private)
@@ -34,6 +46,36 @@ T.test_webview_widget_privacy = function ()
     assert.is_true(v.private)
 end
 
+T.test_webview_widget_placeholder = function ()
+    local v = widget{type="webview"}
+    assert.is_false(v.placeholder)
+
+    v = widget{type="webview", placeholder=true}
+    assert.is_true(v.placeholder)
+    v.uri = "about:blank"
+    v.enable_javascript = false
+    v.can_focus = false
+    assert.is_false(v.is_loading)
+    assert.is_equal("about:blank", v.uri)
+    assert.is_false(v.enable_javascript)
+    assert.is_false(v.can_focus)
+    assert.is_true(v.placeholder)
+
+    -- Properties of the WebKit view replace the placeholder
+    assert.is_number(v.zoom_level)
+    assert.is_false(v.placeholder)
+    assert.is_false(v.enable_javascript)
+    assert.is_false(v.can_focus)
+
+    -- Hidden webviews can be discarded, keeping their session state
+    local state = v.session_state
+    assert.is_true(v:discard())
+    assert.is_true(v.placeholder)
+    assert.is_false(v:discard())
+    assert.is_equal(state, v.session_state)
+    assert.is_false(v.enable_javascript)
+end
+
 return T
 
 -- vim: et:sw=4:ts=8:sts=4:tw=80
@@ -141,7 +141,7 @@ local function spawn_luakit_instance(config, ...)
         cmd = cmd .. k .."=" .. v .. " "
     end
 
-    cmd = cmd .. "./luakit -U --log=error -c " .. config .. " " .. table.concat({...}, " ")  .. " 2>&1"
+    cmd = cmd .. "./luakit --log=error -c " .. config .. " " .. table.concat({...}, " ")  .. " 2>&1"
     return assert(io.popen(cmd))
 end
 
@@ -165,7 +165,9 @@ end)
 
 local function do_async_tests(test_files)
     for _, test_file in ipairs(test_files) do
-        local f = spawn_luakit_instance("tests/async/run_test.lua", test_file)
+        -- Only unique instance tests run as a primary instance
+        local unique = test_file:match("unique") and "" or "-U"
+        local f = spawn_luakit_instance("tests/async/run_test.lua", unique, test_file)
 
         local status, test_name
         for line in f:lines() do
@@ -29,6 +29,7 @@ function T.test_luacheck ()
         "download",
         "stylesheet",
         "unique",
+        "url_index",
         "widget",
         "uris",
         "require_web_module",
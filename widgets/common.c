@@ -25,12 +25,102 @@
 #include "common/luaobject.h"
 #include "common/lualib.h"
 #include "widgets/common.h"
+#include "widgets/webview.h"
+
+/* Native bind keys pack the modifiers that lousy.bind doesn't ignore above
+ * the keyval, which fits in 25 bits */
+static gpointer
+native_bind_key(guint state, guint keyval)
+{
+    guint mods = (state & GDK_SHIFT_MASK ? 1 : 0)
+        | (state & GDK_CONTROL_MASK ? 2 : 0)
+        | (state & GDK_MOD1_MASK ? 4 : 0)
+        | (state & GDK_MOD4_MASK ? 8 : 0);
+    return GUINT_TO_POINTER(keyval | mods << 25);
+}
+
+/* Normalize a key event the same way as lousy.bind.hit(): keys are matched
+ * in lowercase, and shift is ignored for printable keys without case */
+static gpointer
+native_bind_event_key(GdkEventKey *ev)
+{
+    guint keyval = gdk_keyval_to_lower(ev->keyval);
+    guint state = ev->state;
+    if (keyval == gdk_keyval_to_upper(keyval) && g_unichar_isgraph(gdk_keyval_to_unicode(keyval)))
+        state &= ~GDK_SHIFT_MASK;
+    return native_bind_key(state, keyval);
+}
+
+/* Parse a key bind in the syntax used by lousy.bind, like <control-Down>;
+ * returns NULL for binds that can't be matched natively */
+static gpointer
+native_bind_parse(const gchar *bind)
+{
+    gsize len = strlen(bind);
+    if (len < 3 || bind[0] != '<' || bind[len-1] != '>')
+        return NULL;
+
+    gchar *inner = g_strndup(bind + 1, len - 2);
+    gchar **parts = g_strsplit(inner, "-", -1);
+    g_free(inner);
+
+    guint n = g_strv_length(parts), state = 0, keyval;
+    const gchar *key = parts[n-1];
+    gboolean ok = TRUE;
+    for (guint i = 0; i + 1 < n && ok; i++) {
+        if (!strcmp(parts[i], "shift"))
+            state |= GDK_SHIFT_MASK;
+        else if (!strcmp(parts[i], "control"))
+            state |= GDK_CONTROL_MASK;
+        else if (!strcmp(parts[i], "mod1"))
+            state |= GDK_MOD1_MASK;
+        else if (!strcmp(parts[i], "mod4"))
+            state |= GDK_MOD4_MASK;
+        else
+            ok = FALSE;
+    }
+
+    if (g_utf8_strlen(key, -1) == 1)
+        keyval = gdk_unicode_to_keyval(g_utf8_get_char(key));
+    else
+        keyval = gdk_keyval_from_name(key);
+    ok = ok && *key && keyval && keyval != GDK_KEY_VoidSymbol;
+    g_strfreev(parts);
+
+    return ok ? native_bind_key(state, gdk_keyval_to_lower(keyval)) : NULL;
+}
+
+/* Run the native bind for a key event, if there is one. Native binds are
+ * looked up without creating the modifiers table and key name passed to the
+ * key-press signal. Expects the widget on top of the stack. */
+static gboolean
+native_bind_run(lua_State *L, GdkEventKey *ev, widget_t *w)
+{
+    if (!w->native_binds || (ev->send_event && !w->native_binds_synthetic)
+            || ev->state & GDK_LOCK_MASK)
+        return FALSE;
+    gpointer func = g_hash_table_lookup(w->native_binds, native_bind_event_key(ev));
+    if (!func)
+        return FALSE;
+
+    lua_pushvalue(L, -1);
+    luaH_object_push_item(L, -2, func);
+    if (!luaH_dofunction(L, 1, 1))
+        return FALSE;
+    gboolean catch = lua_isnil(L, -1) || lua_toboolean(L, -1);
+    lua_pop(L, 1);
+    return catch;
+}
 
 gboolean
 key_press_cb(GtkWidget* UNUSED(win), GdkEventKey *ev, widget_t *w)
 {
     lua_State *L = common.L;
     luaH_object_push(L, w->ref);
+    if (native_bind_run(L, ev, w)) {
+        lua_pop(L, 1);
+        return TRUE;
+    }
     luaH_modifier_table_push(L, ev->state);
     luaH_keystr_push(L, ev->keyval);
     lua_pushboolean(L, ev->send_event);
@@ -195,6 +285,10 @@ destroy_cb(GtkWidget* UNUSED(win), widget_t *w)
     lua_pop(L, 1);
 
     /* 2. Call widget destructor */
+    if (w->native_binds) {
+        g_hash_table_destroy(w->native_binds);
+        w->native_binds = NULL;
+    }
     debug("destroy %p (%s)", w, w->info->name);
     if (w->destructor)
         w->destructor(w);
@@ -390,9 +484,13 @@ luaH_widget_send_key(lua_State *L)
                           key_name);
     }
 
+    /* Key events are handled by the webview widget, not its container */
+    GtkWidget *target = w->info->tok == L_TK_WEBVIEW ?
+        webview_get_web_view(w, TRUE) : w->widget;
+
     GdkEvent *event = gdk_event_new(is_release ? GDK_KEY_RELEASE : GDK_KEY_PRESS);
     GdkEventKey *event_key = (GdkEventKey *) event;
-    event_key->window = gtk_widget_get_window(w->widget);
+    event_key->window = gtk_widget_get_window(target);
     event_key->send_event = TRUE;
     event_key->time = GDK_CURRENT_TIME;
     event_key->state = state;
@@ -417,14 +515,91 @@ luaH_widget_send_key(lua_State *L)
     gdk_event_set_device(event, kbd);
 
     gboolean ret;
-    debug("sending key '%s%s' to widget %p", state_string->str, key_name, w->widget);
-    g_signal_emit_by_name(w->widget, is_release ? "key-release-event" : "key-press-event", event, &ret);
+    debug("sending key '%s%s' to widget %p", state_string->str, key_name, target);
+    g_signal_emit_by_name(target, is_release ? "key-release-event" : "key-press-event", event, &ret);
 
     g_string_free(state_string, TRUE);
     g_free(keys);
     return 0;
 }
 
+gint
+luaH_widget_set_native_binds(lua_State *L)
+{
+    widget_t *w = luaH_checkwidget(L, 1);
+    if (!lua_isnoneornil(L, 2))
+        luaH_checktable(L, 2);
+
+    /* Release the previous bind functions */
+    if (w->native_binds) {
+        GHashTableIter iter;
+        gpointer func;
+        g_hash_table_iter_init(&iter, w->native_binds);
+        while (g_hash_table_iter_next(&iter, NULL, &func))
+            luaH_object_unref_item(L, 1, func);
+        g_hash_table_destroy(w->native_binds);
+        w->native_binds = NULL;
+    }
+    if (lua_isnoneornil(L, 2))
+        return 0;
+
+    w->native_binds_synthetic = lua_toboolean(L, 3);
+    w->native_binds = g_hash_table_new(g_direct_hash, g_direct_equal);
+    lua_pushnil(L);
+    while (lua_next(L, 2)) {
+        if (lua_type(L, -2) != LUA_TSTRING || !lua_isfunction(L, -1))
+            return luaL_error(L, "native binds must map bind strings to functions");
+        gpointer key = native_bind_parse(lua_tostring(L, -2));
+        if (key && !g_hash_table_contains(w->native_binds, key)) {
+            lua_pushvalue(L, -1);
+            g_hash_table_insert(w->native_binds, key, luaH_object_ref_item(L, 1, -1));
+        } else if (!key)
+            debug("bind '%s' can't be matched natively", lua_tostring(L, -2));
+        lua_pop(L, 1);
+    }
+    return 0;
+}
+
+typedef struct {
+    widget_t *w;
+    gpointer func;
+} frame_callback_t;
+
+static gboolean
+frame_cb(GtkWidget *UNUSED(widget), GdkFrameClock *UNUSED(clock), frame_callback_t *cb)
+{
+    lua_State *L = common.L;
+    luaH_object_push(L, cb->w->ref);
+    luaH_object_push_item(L, -1, cb->func);
+    luaH_object_unref_item(L, -2, cb->func);
+    luaH_dofunction(L, 0, 0);
+    lua_pop(L, 1);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+frame_callback_free(frame_callback_t *cb)
+{
+    g_slice_free(frame_callback_t, cb);
+}
+
+/* Call a function once, before the next frame of the widget is drawn. The
+ * function is only called once the widget is realized, and never if the
+ * widget is destroyed first. */
+gint
+luaH_widget_on_next_frame(lua_State *L)
+{
+    widget_t *w = luaH_checkwidget(L, 1);
+    luaH_checkfunction(L, 2);
+
+    frame_callback_t *cb = g_slice_new(frame_callback_t);
+    cb->w = w;
+    cb->func = luaH_object_ref_item(L, 1, 2);
+    gtk_widget_add_tick_callback(w->widget, (GtkTickCallback)frame_cb, cb,
+            (GDestroyNotify)frame_callback_free);
+    return 0;
+}
+
 gint
 luaH_widget_set_visible(lua_State *L, widget_t *w)
 {
@@ -552,9 +727,20 @@ luaH_widget_get_parent(lua_State *L, widget_t *w)
 gint
 luaH_widget_get_focused(lua_State *L, widget_t *w)
 {
-    gboolean focused = w->info->tok == L_TK_WINDOW ?
-        gtk_window_has_toplevel_focus(GTK_WINDOW(w->widget)) :
-        gtk_widget_is_focus(w->widget);
+    gboolean focused;
+    GtkWidget *view;
+    switch (w->info->tok) {
+        case L_TK_WINDOW:
+            focused = gtk_window_has_toplevel_focus(GTK_WINDOW(w->widget));
+            break;
+        case L_TK_WEBVIEW:
+            view = webview_get_web_view(w, FALSE);
+            focused = view && gtk_widget_is_focus(view);
+            break;
+        default:
+            focused = gtk_widget_is_focus(w->widget);
+            break;
+    }
     lua_pushboolean(L, focused);
     return 1;
 }
@@ -593,6 +779,9 @@ luaH_widget_focus(lua_State *L)
         case L_TK_ENTRY:
             gtk_entry_grab_focus_without_selecting(GTK_ENTRY(w->widget));
             break;
+        case L_TK_WEBVIEW:
+            gtk_widget_grab_focus(webview_get_web_view(w, TRUE));
+            break;
         default:
             gtk_widget_grab_focus(w->widget);
             break;
@@ -20,6 +20,7 @@
 
 #include "luah.h"
 #include "widgets/common.h"
+#include "widgets/image.h"
 #include "web_context.h"
 #include "common/resource.h"
 
@@ -150,18 +151,130 @@ luaH_image_scale(lua_State *L)
     return 0;
 }
 
+/* Scaled favicons are shared by all image widgets, so that tabs showing the
+ * same site don't each scale their own copy of its icon. Entries are keyed by
+ * favicon URI and size in device pixels, and evicted least recently used
+ * first; widgets showing an evicted favicon keep their own reference to it. */
+
+#define FAVICON_SIZE 16
+#define FAVICON_CACHE_SIZE 256
+
+typedef struct {
+    gchar *key;
+    gchar *favicon_uri;
+    cairo_surface_t *surface;
+} favicon_entry_t;
+
+typedef struct {
+    widget_t *w;
+    gchar *key;
+    gchar *favicon_uri;
+} favicon_request_t;
+
+/** Map from key to link in favicon_lru */
+static GHashTable *favicon_cache;
+/** Cache entries, most recently used first */
+static GQueue favicon_lru = G_QUEUE_INIT;
+static struct {
+    guint64 hits, misses, evictions;
+} favicon_cache_stats;
+
+static void
+favicon_entry_free(favicon_entry_t *entry)
+{
+    g_free(entry->key);
+    g_free(entry->favicon_uri);
+    cairo_surface_destroy(entry->surface);
+    g_slice_free(favicon_entry_t, entry);
+}
+
+static void
+favicon_cache_remove_link(GList *link)
+{
+    favicon_entry_t *entry = link->data;
+    g_hash_table_remove(favicon_cache, entry->key);
+    g_queue_delete_link(&favicon_lru, link);
+    favicon_entry_free(entry);
+}
+
+/* Favicons are re-fetched from the database once changed */
+static void
+favicon_changed_cb(WebKitFaviconDatabase *UNUSED(fdb), const gchar *UNUSED(page_uri),
+        const gchar *favicon_uri, gpointer UNUSED(user_data))
+{
+    for (GList *link = favicon_lru.head, *next; link; link = next) {
+        next = link->next;
+        if (!g_strcmp0(((favicon_entry_t*)link->data)->favicon_uri, favicon_uri))
+            favicon_cache_remove_link(link);
+    }
+}
+
+static cairo_surface_t *
+favicon_cache_lookup(const gchar *key)
+{
+    GList *link = g_hash_table_lookup(favicon_cache, key);
+    if (!link)
+        return NULL;
+    g_queue_unlink(&favicon_lru, link);
+    g_queue_push_head_link(&favicon_lru, link);
+    return ((favicon_entry_t*)link->data)->surface;
+}
+
+static void
+favicon_cache_insert(const gchar *key, const gchar *favicon_uri, cairo_surface_t *surface)
+{
+    favicon_entry_t *entry = g_slice_new(favicon_entry_t);
+    entry->key = g_strdup(key);
+    entry->favicon_uri = g_strdup(favicon_uri);
+    entry->surface = cairo_surface_reference(surface);
+    g_queue_push_head(&favicon_lru, entry);
+    g_hash_table_insert(favicon_cache, entry->key, favicon_lru.head);
+
+    while (favicon_lru.length > FAVICON_CACHE_SIZE) {
+        favicon_cache_remove_link(favicon_lru.tail);
+        favicon_cache_stats.evictions++;
+    }
+}
+
+/** Drop all cached favicons. */
 void
-luaH_image_set_favicon_for_uri_finished(WebKitFaviconDatabase *fdb, GAsyncResult *res, widget_t *w)
+favicon_cache_clear(void)
 {
-    cairo_surface_t *source = webkit_favicon_database_get_favicon_finish(fdb, res, NULL);
-    if (!source)
-        return;
+    while (favicon_lru.head)
+        favicon_cache_remove_link(favicon_lru.head);
+}
 
-    /* Source width/height, scale factor, target logical size, target device size */
+/** Push a table of favicon cache statistics.
+ *
+ * \param L The Lua VM state.
+ * \return  The number of elements pushed on the stack.
+ */
+gint
+luaH_favicon_cache_push_stats(lua_State *L)
+{
+    guint64 lookups = favicon_cache_stats.hits + favicon_cache_stats.misses;
+    lua_createtable(L, 0, 5);
+    lua_pushinteger(L, favicon_lru.length);
+    lua_setfield(L, -2, "size");
+    lua_pushnumber(L, favicon_cache_stats.hits);
+    lua_setfield(L, -2, "hits");
+    lua_pushnumber(L, favicon_cache_stats.misses);
+    lua_setfield(L, -2, "misses");
+    lua_pushnumber(L, favicon_cache_stats.evictions);
+    lua_setfield(L, -2, "evictions");
+    lua_pushnumber(L, lookups ? (gdouble)favicon_cache_stats.hits / lookups : 0);
+    lua_setfield(L, -2, "hit_rate");
+    return 1;
+}
+
+/* Scale a favicon to FAVICON_SIZE logical pixels */
+static cairo_surface_t *
+favicon_scale(cairo_surface_t *source, gint scale)
+{
+    /* Source width/height, target logical size, target device size */
     float src_w = cairo_image_surface_get_width(source);
     float src_h = cairo_image_surface_get_height(source);
-    float scale = gtk_widget_get_scale_factor(w->widget);
-    float log_sz = 16, dev_sz = log_sz*scale;
+    float log_sz = FAVICON_SIZE, dev_sz = log_sz*scale;
 
     cairo_surface_t *target = cairo_surface_create_similar(source,
             CAIRO_CONTENT_COLOR_ALPHA, dev_sz, dev_sz);
@@ -172,11 +285,40 @@ luaH_image_set_favicon_for_uri_finished(WebKitFaviconDatabase *fdb, GAsyncResult
     cairo_set_source_surface(cr, source, 0, 0);
     cairo_surface_set_device_offset(source, 0, 0);
     cairo_paint(cr);
+    cairo_destroy(cr);
 
-    gtk_image_set_from_surface(GTK_IMAGE(w->widget), target);
+    return target;
+}
+
+static void
+favicon_request_free(favicon_request_t *req)
+{
+    g_free(req->key);
+    g_free(req->favicon_uri);
+    g_slice_free(favicon_request_t, req);
+}
+
+static void
+luaH_image_set_favicon_for_uri_finished(WebKitFaviconDatabase *fdb, GAsyncResult *res, favicon_request_t *req)
+{
+    cairo_surface_t *source = webkit_favicon_database_get_favicon_finish(fdb, res, NULL);
+    if (!source) {
+        favicon_request_free(req);
+        return;
+    }
+
+    /* Another widget may have fetched the same favicon in the meantime */
+    cairo_surface_t *target = favicon_cache_lookup(req->key);
+    if (target)
+        gtk_image_set_from_surface(GTK_IMAGE(req->w->widget), target);
+    else {
+        target = favicon_scale(source, gtk_widget_get_scale_factor(req->w->widget));
+        favicon_cache_insert(req->key, req->favicon_uri, target);
+        gtk_image_set_from_surface(GTK_IMAGE(req->w->widget), target);
+        cairo_surface_destroy(target);
+    }
     cairo_surface_destroy(source);
-    cairo_surface_destroy(target);
-    cairo_destroy(cr);
+    favicon_request_free(req);
 }
 
 static gint
@@ -190,17 +332,36 @@ luaH_image_set_favicon_for_uri(lua_State *L)
     gchar *f_uri;
     gboolean ok = TRUE;
 
-    if ((f_uri = webkit_favicon_database_get_favicon_uri(main_fdb, uri))) {
-        g_free(f_uri);
+    if (!favicon_cache) {
+        favicon_cache = g_hash_table_new(g_str_hash, g_str_equal);
+        g_signal_connect(main_fdb, "favicon-changed", G_CALLBACK(favicon_changed_cb), NULL);
+    }
 
+    if ((f_uri = webkit_favicon_database_get_favicon_uri(main_fdb, uri))) {
         if (w->data) {
             g_cancellable_cancel(w->data);
             g_clear_object(&w->data);
         }
-        w->data = g_cancellable_new();
 
-        webkit_favicon_database_get_favicon(main_fdb, uri, w->data,
-                (GAsyncReadyCallback)luaH_image_set_favicon_for_uri_finished, w);
+        gint scale = gtk_widget_get_scale_factor(w->widget);
+        gchar *key = g_strdup_printf("%d %s", FAVICON_SIZE*scale, f_uri);
+        cairo_surface_t *target = favicon_cache_lookup(key);
+
+        if (target) {
+            favicon_cache_stats.hits++;
+            gtk_image_set_from_surface(GTK_IMAGE(w->widget), target);
+            g_free(key);
+            g_free(f_uri);
+        } else {
+            favicon_cache_stats.misses++;
+            favicon_request_t *req = g_slice_new(favicon_request_t);
+            req->w = w;
+            req->key = key;
+            req->favicon_uri = f_uri;
+            w->data = g_cancellable_new();
+            webkit_favicon_database_get_favicon(main_fdb, uri, w->data,
+                    (GAsyncReadyCallback)luaH_image_set_favicon_for_uri_finished, req);
+        }
     } else
         ok = FALSE;
 
@@ -180,11 +180,33 @@ luaH_scrolled_newindex(lua_State *L, widget_t *w, luakit_token_t token)
     return luaH_object_property_signal(L, 1, token);
 }
 
+static void
+adjustment_value_changed_cb(GtkAdjustment *UNUSED(a), widget_t *w)
+{
+    /* Adjustments are reset while the widget is being destroyed */
+    if (!w->widget)
+        return;
+    lua_State *L = common.L;
+    luaH_object_push(L, w->ref);
+    luaH_object_emit_signal(L, -1, "property::scroll", 0, 0);
+    lua_pop(L, 1);
+}
+
+/* The adjustments can outlive the widget, if a child still holds them */
+static void
+scrolled_destructor(widget_t *w)
+{
+    GtkScrolledWindow *sw = GTK_SCROLLED_WINDOW(w->widget);
+    g_signal_handlers_disconnect_by_data(gtk_scrolled_window_get_hadjustment(sw), w);
+    g_signal_handlers_disconnect_by_data(gtk_scrolled_window_get_vadjustment(sw), w);
+}
+
 widget_t *
 widget_scrolled(lua_State *UNUSED(L), widget_t *w, luakit_token_t UNUSED(token))
 {
     w->index = luaH_scrolled_index;
     w->newindex = luaH_scrolled_newindex;
+    w->destructor = scrolled_destructor;
 
 #if GTK_CHECK_VERSION(3,2,0)
     w->widget = gtk_scrolled_window_new(NULL, NULL);
@@ -194,6 +216,12 @@ widget_scrolled(lua_State *UNUSED(L), widget_t *w, luakit_token_t UNUSED(token))
         LUAKIT_WIDGET_SIGNAL_COMMON(w)
         NULL);
 
+    GtkScrolledWindow *sw = GTK_SCROLLED_WINDOW(w->widget);
+    g_signal_connect(gtk_scrolled_window_get_hadjustment(sw), "value-changed",
+            G_CALLBACK(adjustment_value_changed_cb), w);
+    g_signal_connect(gtk_scrolled_window_get_vadjustment(sw), "value-changed",
+            G_CALLBACK(adjustment_value_changed_cb), w);
+
     gtk_widget_show(w->widget);
     return w;
 }
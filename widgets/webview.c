@@ -32,14 +32,28 @@
 #include "web_context.h"
 #include "common/ipc.h"
 #include "common/luayield.h"
+#include "common/trace.h"
 
 typedef struct {
     /** The parent widget_t struct */
     widget_t *widget;
-    /** The webview widget */
+    /** The webview widget, or NULL while the webview is a placeholder */
     WebKitWebView *view;
-    /** The user content manager for the webview */
+    /** The user content manager for the webview; created with the webview
+     * widget */
     WebKitUserContentManager *user_content;
+    /** The settings for the webview; created when first used, and kept while
+     * it is a placeholder */
+    WebKitSettings *settings;
+    /** Session state to restore when the webview widget is created */
+    GBytes *pending_state;
+    /** Title of the page shown before the webview was discarded */
+    gchar *title;
+    /** Whether to emit property::placeholder when the webview widget is
+     * created */
+    gboolean notify_placeholder;
+    /** Whether the webview widget can take keyboard focus */
+    gboolean can_focus;
     /** A list of stylesheets enabled for this user content */
     GList *stylesheets;
     /** Helpers for user content manager updating */
@@ -73,11 +87,21 @@ typedef struct {
 
     ipc_endpoint_t *ipc;
     pid_t web_process_id;
+    /** Page id of the WebKitWebView, used as the key into webviews_by_id */
+    guint64 page_id;
+
+    /** Pending eval_js requests, sent together when idle */
+    GByteArray *eval_js_batch;
+    guint eval_js_batch_id;
 } webview_data_t;
 
 static WebKitWebView *related_view;
 
-#define luaH_checkwvdata(L, udx) ((webview_data_t*)(luaH_checkwebview(L, udx)->data))
+/** Map from page id to the webview showing that page */
+static GHashTable *webviews_by_id;
+
+static WebKitWebView *webview_ensure_view(widget_t *w);
+static webview_data_t *luaH_checkwvdata(lua_State *L, gint udx);
 
 static struct {
     GSList *refs;
@@ -156,15 +180,36 @@ luaH_checkwebview(lua_State *L, gint udx)
     return w;
 }
 
+/* Most methods need the WebKitWebView, so placeholders are replaced by it */
+static webview_data_t*
+luaH_checkwvdata(lua_State *L, gint udx)
+{
+    widget_t *w = luaH_checkwebview(L, udx);
+    webview_ensure_view(w);
+    return w->data;
+}
+
+/* Get the settings of a webview, creating them if necessary */
+static WebKitSettings*
+webview_get_settings(webview_data_t *d)
+{
+    if (!d->settings)
+        d->settings = webkit_settings_new();
+    return d->settings;
+}
+
 widget_t*
 webview_get_by_id(guint64 view_id)
 {
-    for (unsigned i = 0; i < globalconf.webviews->len; i++) {
-        widget_t *w = g_ptr_array_index(globalconf.webviews, i);
-        if (webkit_web_view_get_page_id(WEBKIT_WEB_VIEW(w->widget)) == view_id)
-            return w;
-    }
-    return NULL;
+    return webviews_by_id ? g_hash_table_lookup(webviews_by_id, &view_id) : NULL;
+}
+
+GtkWidget*
+webview_get_web_view(widget_t *w, gboolean create)
+{
+    g_assert(w->info->tok == L_TK_WEBVIEW);
+    webview_data_t *d = w->data;
+    return GTK_WIDGET(create ? webview_ensure_view(w) : d->view);
 }
 
 static void update_uri(widget_t *w, const gchar *uri);
@@ -449,7 +494,7 @@ create_cb(WebKitWebView* v, WebKitNavigationAction* UNUSED(a), widget_t *w)
     if (ret) {
         if ((new = luaH_towidget(L, -1))) {
             if (new->info->tok == L_TK_WEBVIEW)
-                view = WEBKIT_WEB_VIEW(((webview_data_t*)new->data)->view);
+                view = webview_ensure_view(new);
             else
                 warn("invalid return widget type (expected webview, got %s)",
                         new->info->name);
@@ -554,19 +599,23 @@ decide_policy_cb(WebKitWebView* UNUSED(v), WebKitPolicyDecision *p,
     return FALSE;
 }
 
+/* Placeholders load their location once shown, so there is nothing to
+ * reload or stop yet */
 static gint
 luaH_webview_reload(lua_State *L)
 {
-    webview_data_t *d = luaH_checkwvdata(L, 1);
-    webkit_web_view_reload(d->view);
+    webview_data_t *d = luaH_checkwebview(L, 1)->data;
+    if (d->view)
+        webkit_web_view_reload(d->view);
     return 0;
 }
 
 static gint
 luaH_webview_reload_bypass_cache(lua_State *L)
 {
-    webview_data_t *d = luaH_checkwvdata(L, 1);
-    webkit_web_view_reload_bypass_cache(d->view);
+    webview_data_t *d = luaH_checkwebview(L, 1)->data;
+    if (d->view)
+        webkit_web_view_reload_bypass_cache(d->view);
     return 0;
 }
 
@@ -622,16 +671,20 @@ luaH_webview_clear_search(lua_State *L)
 static gint
 luaH_webview_loading(lua_State *L)
 {
-    webview_data_t *d = luaH_checkwvdata(L, 1);
-    luaH_gobject_index(L, webview_properties, L_TK_IS_LOADING, G_OBJECT(d->view));
+    webview_data_t *d = luaH_checkwebview(L, 1)->data;
+    if (!d->view)
+        lua_pushboolean(L, FALSE);
+    else
+        luaH_gobject_index(L, webview_properties, L_TK_IS_LOADING, G_OBJECT(d->view));
     return 1;
 }
 
 static gint
 luaH_webview_stop(lua_State *L)
 {
-    webview_data_t *d = luaH_checkwvdata(L, 1);
-    webkit_web_view_stop_loading(d->view);
+    webview_data_t *d = luaH_checkwebview(L, 1)->data;
+    if (d->view)
+        webkit_web_view_stop_loading(d->view);
     return 0;
 }
 
@@ -653,7 +706,9 @@ luaH_webview_crash(lua_State *L)
 static gint
 luaH_webview_ssl_trusted(lua_State *L)
 {
-    webview_data_t *d = luaH_checkwvdata(L, 1);
+    webview_data_t *d = luaH_checkwebview(L, 1)->data;
+    if (!d->view)
+        return 0;
     const gchar *uri = webkit_web_view_get_uri(d->view);
     GTlsCertificate *cert;
     GTlsCertificateFlags cert_errors;
@@ -671,7 +726,7 @@ static gint
 luaH_webview_allow_certificate(lua_State *L)
 {
     warn("webview:allow_certificate() is deprecated: use luakit.allow_certificate() instead");
-    (void)luaH_checkwvdata(L, 1);
+    (void)luaH_checkwebview(L, 1);
     lua_remove(L, 1);
     luaL_checkstring(L, 1);
     luaL_checkstring(L, 2);
@@ -703,6 +758,57 @@ webview_translate_old_token(luakit_token_t token)
     }
 }
 
+/* Apply a table of properties, only setting those whose value has changed.
+ * Property change notifications are deferred until all have been set, and
+ * returns the number of properties that were changed */
+static gint
+luaH_webview_set_settings(lua_State *L)
+{
+    webview_data_t *d = luaH_checkwvdata(L, 1);
+    luaH_checktable(L, 2);
+
+    GObject *view = G_OBJECT(d->view);
+    GObject *settings = G_OBJECT(webview_get_settings(d));
+    GArray *changed = g_array_new(FALSE, FALSE, sizeof(luakit_token_t));
+
+    g_object_freeze_notify(view);
+    g_object_freeze_notify(settings);
+
+    lua_pushnil(L);
+    while (lua_next(L, 2)) {
+        luakit_token_t token = lua_type(L, -2) == LUA_TSTRING ?
+            webview_translate_old_token(l_tokenize(lua_tostring(L, -2))) : L_TK_UNKNOWN;
+        gint ret = luaH_gobject_update(L, webview_properties, token, -1, view);
+        if (ret < 0)
+            ret = luaH_gobject_update(L, webview_settings_properties, token, -1, settings);
+
+        if (ret > 0) {
+            if (token == L_TK_ZOOM_LEVEL && lua_tonumber(L, -1) != 1.0) {
+                /* See the zoom_level workaround in luaH_webview_newindex() */
+                g_object_set(view, "zoom-level", 1.0, NULL);
+                g_object_set(view, "zoom-level", lua_tonumber(L, -1), NULL);
+            }
+            g_array_append_val(changed, token);
+        } else if (ret < 0) {
+            /* Fall back to the regular property setter */
+            lua_pushvalue(L, -2);
+            lua_pushvalue(L, -2);
+            lua_settable(L, 1);
+        }
+        lua_pop(L, 1);
+    }
+
+    g_object_thaw_notify(settings);
+    g_object_thaw_notify(view);
+
+    for (guint i = 0; i < changed->len; i++)
+        luaH_object_property_signal(L, 1, g_array_index(changed, luakit_token_t, i));
+
+    lua_pushinteger(L, changed->len);
+    g_array_free(changed, TRUE);
+    return 1;
+}
+
 static void
 favicon_cb(WebKitWebView* UNUSED(v), GParamSpec *UNUSED(param_spec), widget_t *w)
 {
@@ -760,12 +866,12 @@ permission_request_cb(WebKitWebView *UNUSED(v), WebKitPermissionRequest *request
 static gint
 luaH_webview_set_pdfjs(lua_State *L)
 {
-    webview_data_t *d = luaH_checkwvdata(L, 1);
+    webview_data_t *d = luaH_checkwebview(L, 1)->data;
     gboolean enabled = luaH_checkboolean(L, 2);
 
     g_autoptr(WebKitFeatureList) features
         = webkit_settings_get_all_features();
-    WebKitSettings *settings = webkit_web_view_get_settings(d->view);
+    WebKitSettings *settings = webview_get_settings(d);
 
     for (gsize i = 0; i < webkit_feature_list_get_length(features); i++) {
         WebKitFeature *feature = webkit_feature_list_get(features, i);
@@ -780,6 +886,79 @@ luaH_webview_set_pdfjs(lua_State *L)
     return 0;
 }
 
+static void
+webview_disconnect_view(widget_t *w)
+{
+    webview_data_t *d = w->data;
+    g_signal_handlers_disconnect_by_data(d->view, w);
+    g_signal_handlers_disconnect_by_data(
+            webkit_web_view_get_find_controller(d->view), w);
+    g_signal_handlers_disconnect_by_data(d->inspector, w);
+    g_hash_table_remove(webviews_by_id, &d->page_id);
+    webview_set_web_process_id(w, 0);
+}
+
+/* Destroy the webview widget of a hidden webview, keeping its session state
+ * and title; it is created again when next shown */
+static gint
+luaH_webview_discard(lua_State *L)
+{
+    widget_t *w = luaH_checkwebview(L, 1);
+    webview_data_t *d = w->data;
+
+    if (!d->view || gtk_widget_get_mapped(w->widget)) {
+        lua_pushboolean(L, FALSE);
+        return 1;
+    }
+
+    WebKitWebViewSessionState *state = webkit_web_view_get_session_state(d->view);
+    if (d->pending_state)
+        g_bytes_unref(d->pending_state);
+    d->pending_state = webkit_web_view_session_state_serialize(state);
+    webkit_web_view_session_state_unref(state);
+    g_free(d->title);
+    d->title = g_strdup(webkit_web_view_get_title(d->view));
+
+    /* Requests for the old page are dropped; their callbacks are released by
+     * the webview destroy signal */
+    eval_js_batch_cancel(w);
+
+    webview_disconnect_view(w);
+    gtk_widget_destroy(GTK_WIDGET(d->view));
+    d->view = NULL;
+    d->inspector = NULL;
+    d->inspector_open = FALSE;
+    d->is_committed = FALSE;
+    d->is_failed = FALSE;
+    d->htr_context = 0;
+    d->doc_w = d->doc_h = d->win_w = d->win_h = d->scroll_x = d->scroll_y = 0;
+    g_free(d->hover);
+    d->hover = NULL;
+    if (d->cert) {
+        g_object_unref(G_OBJECT(d->cert));
+        d->cert = NULL;
+    }
+
+    /* The new page will connect to a web extension of its own */
+    ipc_endpoint_decref(d->ipc);
+    d->ipc = NULL;
+
+    d->notify_placeholder = TRUE;
+    luaH_object_property_signal(L, 1, L_TK_PLACEHOLDER);
+
+    lua_pushboolean(L, TRUE);
+    return 1;
+}
+
+static gboolean
+webview_is_view_property(luakit_token_t token)
+{
+    for (property_t *p = webview_properties; p->tok; p++)
+        if (p->tok == token)
+            return TRUE;
+    return FALSE;
+}
+
 static gint
 luaH_webview_index(lua_State *L, widget_t *w, luakit_token_t token)
 {
@@ -788,10 +967,30 @@ luaH_webview_index(lua_State *L, widget_t *w, luakit_token_t token)
 
     token = webview_translate_old_token(token);
 
+    /* Answer what we can for placeholders without creating the webview */
+    if (!d->view) {
+        switch(token) {
+          PB_CASE(IS_LOADING,       FALSE)
+          PB_CASE(IS_PLAYING_AUDIO, FALSE)
+          PN_CASE(PROGRESS,         0)
+          PS_CASE(TITLE,            d->title)
+          case L_TK_ID:
+          case L_TK_HISTORY:
+            webview_ensure_view(w);
+            break;
+          default:
+            if (webview_is_view_property(token))
+                webview_ensure_view(w);
+            break;
+        }
+    }
+
     switch(token) {
       LUAKIT_WIDGET_INDEX_COMMON(w)
       PB_CASE(INSPECTOR,            d->inspector_open);
       PB_CASE(PRIVATE,              d->private);
+      PB_CASE(PLACEHOLDER,          !d->view);
+      PB_CASE(CAN_FOCUS,            d->can_focus);
 
       /* push property methods */
       PF_CASE(CLEAR_SEARCH,         luaH_webview_clear_search)
@@ -821,6 +1020,8 @@ luaH_webview_index(lua_State *L, widget_t *w, luakit_token_t token)
 
       PF_CASE(ALLOW_CERTIFICATE,    luaH_webview_allow_certificate)
       PF_CASE(SET_PDFJS,            luaH_webview_set_pdfjs)
+      PF_CASE(SET_SETTINGS,         luaH_webview_set_settings)
+      PF_CASE(DISCARD,              luaH_webview_discard)
 
       /* push string properties */
       PS_CASE(HOVERED_URI,          d->hover)
@@ -861,7 +1062,7 @@ luaH_webview_index(lua_State *L, widget_t *w, luakit_token_t token)
     if (token == L_TK_HARDWARE_ACCELERATION_POLICY) {
         /* HACK: there's only one exposed property that has an enum type, so we
          * special-case it; this should be refactored if there's more than one */
-        switch (webkit_settings_get_hardware_acceleration_policy(webkit_web_view_get_settings(d->view))) {
+        switch (webkit_settings_get_hardware_acceleration_policy(webview_get_settings(d))) {
             case WEBKIT_HARDWARE_ACCELERATION_POLICY_ON_DEMAND: lua_pushstring (L, "on-demand"); return 1;
             case WEBKIT_HARDWARE_ACCELERATION_POLICY_ALWAYS: lua_pushstring (L, "always"); return 1;
             case WEBKIT_HARDWARE_ACCELERATION_POLICY_NEVER: lua_pushstring (L, "never"); return 1;
@@ -870,7 +1071,7 @@ luaH_webview_index(lua_State *L, widget_t *w, luakit_token_t token)
     }
 
     if ((ret = luaH_gobject_index(L, webview_settings_properties, token,
-            G_OBJECT(webkit_web_view_get_settings(d->view)))))
+            G_OBJECT(webview_get_settings(d)))))
         return ret;
 
     return luaL_error(L, "cannot get unknown webview property '%s'", lua_tostring(L, 2));
@@ -916,7 +1117,10 @@ luaH_webview_newindex(lua_State *L, widget_t *w, luakit_token_t token)
 
       case L_TK_URI:
         uri = parse_uri(luaL_checklstring(L, 3, &len));
-        webkit_web_view_load_uri(d->view, uri);
+        /* Placeholders load the uri once shown, unless a pending session
+         * state has a page of its own */
+        if (d->view)
+            webkit_web_view_load_uri(d->view, uri);
         update_uri(w, uri);
         g_free(uri);
         return 0;
@@ -925,10 +1129,27 @@ luaH_webview_newindex(lua_State *L, widget_t *w, luakit_token_t token)
         luaH_webview_set_session_state(L, d);
         return 0;
 
+      case L_TK_TITLE:
+        /* Placeholders show the given title until their page is loaded */
+        if (d->view)
+            break;
+        g_free(d->title);
+        d->title = g_strdup(luaL_checkstring(L, 3));
+        return luaH_object_property_signal(L, 1, token);
+
+      case L_TK_CAN_FOCUS:
+        d->can_focus = luaH_checkboolean(L, 3);
+        if (d->view)
+            gtk_widget_set_can_focus(GTK_WIDGET(d->view), d->can_focus);
+        return luaH_object_property_signal(L, 1, token);
+
       default:
         break;
     }
 
+    if (!d->view && webview_is_view_property(token))
+        webview_ensure_view(w);
+
     /* If setting view.zoom_level = x, x != 1.0, then first reset zoom_level
      * This prevents an issue where the zoom_level is ignored after a view crash
      * https://github.com/luakit/luakit/issues/357 */
@@ -955,14 +1176,14 @@ luaH_webview_newindex(lua_State *L, widget_t *w, luakit_token_t token)
             value = WEBKIT_HARDWARE_ACCELERATION_POLICY_NEVER;
         else
             return luaL_error(L, "invalid value (expected one of 'on-demand', 'always', 'never')");
-        webkit_settings_set_hardware_acceleration_policy(webkit_web_view_get_settings(d->view), value);
+        webkit_settings_set_hardware_acceleration_policy(webview_get_settings(d), value);
         emit = TRUE;
     }
 
     /* check for webkit widget's settings gobject properties */
     if (!emit)
         emit = luaH_gobject_newindex(L, webview_settings_properties, token, 3,
-            G_OBJECT(webkit_web_view_get_settings(d->view)));
+            G_OBJECT(webview_get_settings(d)));
 
     if (emit)
         return luaH_object_property_signal(L, 1, token);
@@ -1268,16 +1489,36 @@ webview_destructor(widget_t *w)
 {
     webview_data_t *d = w->data;
 
+    eval_js_batch_cancel(w);
+    if (d->eval_js_batch)
+        g_byte_array_unref(d->eval_js_batch);
+
     g_idle_remove_by_data(w);
 
-    g_assert(d->ipc);
-    ipc_endpoint_decref(d->ipc);
-    d->ipc = NULL;
+    if (d->ipc) {
+        ipc_endpoint_decref(d->ipc);
+        d->ipc = NULL;
+    }
+
+    /* The webview widget is destroyed after its container */
+    if (d->view)
+        webview_disconnect_view(w);
 
     g_ptr_array_remove(globalconf.webviews, w);
+    for (GList *l = d->stylesheets; l; l = l->next) {
+        lstylesheet_t *stylesheet = l->data;
+        g_ptr_array_remove_fast(stylesheet->webviews, w);
+    }
+    g_list_free(d->stylesheets);
     g_free(d->uri);
     g_free(d->hover);
-    g_object_unref(G_OBJECT(d->user_content));
+    g_free(d->title);
+    if (d->user_content)
+        g_object_unref(G_OBJECT(d->user_content));
+    if (d->settings)
+        g_object_unref(G_OBJECT(d->settings));
+    if (d->pending_state)
+        g_bytes_unref(d->pending_state);
     if (d->cert)
         g_object_unref(G_OBJECT(d->cert));
 
@@ -1311,7 +1552,12 @@ webview_crashed_cb(WebKitWebView *UNUSED(view), widget_t *w)
 {
     /* Give webview a new disconnected IPC endpoint */
     webview_data_t *d = w->data;
+    if (d->eval_js_batch_id)
+        ipc_endpoint_remove_batched(d->ipc, w);
     d->ipc = ipc_endpoint_new("UI");
+    if (d->eval_js_batch_id)
+        ipc_endpoint_add_batched(d->ipc, w);
+    webview_set_web_process_id(w, 0);
 
     /* Emit 'crashed' signal on web view */
     lua_State *L = common.L;
@@ -1346,6 +1592,12 @@ webview_connect_to_endpoint(widget_t *w, ipc_endpoint_t *ipc)
         lua_settop(L, top);
     }
 
+    static gboolean first_loaded;
+    if (!first_loaded) {
+        first_loaded = TRUE;
+        trace_milestone("web-extension-loaded");
+    }
+
     /* Emit 'web-extension-loaded' signal on webview */
     luaH_object_push(L, w->ref);
     if (!lua_isnil(L, -1))
@@ -1368,61 +1620,50 @@ webview_set_web_process_id(widget_t *w, pid_t pid)
     d->web_process_id = pid;
 }
 
-widget_t *
-widget_webview(lua_State *L, widget_t *w, luakit_token_t UNUSED(token))
+static void
+webview_map_cb(GtkWidget *UNUSED(box), widget_t *w)
 {
-    w->index = luaH_webview_index;
-    w->newindex = luaH_webview_newindex;
-    w->destructor = webview_destructor;
-
-    /* create private webview data struct */
-    webview_data_t *d = g_slice_new0(webview_data_t);
-    d->widget = w;
-    w->data = d;
-
-    /* Determine whether webview should be ephemeral */
-    /* Lua stack: [{class meta}, {props}, new widget, "type", "webview"] */
-    gint prop_tbl_idx = luaH_absindex(L, -4);
-    g_assert(lua_istable(L, prop_tbl_idx));
-    lua_pushstring(L, "private");
-    lua_rawget(L, prop_tbl_idx);
-    gboolean private = lua_type(L, -1) == LUA_TNIL ? FALSE : lua_toboolean(L, -1);
-    lua_pop(L, 1);
-    d->private = private;
-
-    /* keep a list of all webview widgets */
-    if (!globalconf.webviews)
-        globalconf.webviews = g_ptr_array_new();
-
-    if (!globalconf.stylesheets)
-        globalconf.stylesheets = g_ptr_array_new();
-    d->stylesheets = NULL;
+    webview_ensure_view(w);
+}
 
-    /* Set web process limits if not already set */
-    web_context_init_finish();
+/* Create the webview widget of a placeholder, and load the location that was
+ * set on it */
+static WebKitWebView*
+webview_ensure_view(widget_t *w)
+{
+    webview_data_t *d = w->data;
+    if (d->view)
+        return d->view;
+
+    /* Placeholders only keep their settings and enabled stylesheets; create
+     * everything else the webview widget needs now */
+    if (!d->user_content) {
+        d->user_content = webkit_user_content_manager_new();
+        d->stylesheet_added = d->stylesheets != NULL;
+        webview_stylesheets_regenerate(w);
+    }
+    /* Create a new endpoint with one ref (this webview) */
+    if (!d->ipc)
+        d->ipc = ipc_endpoint_new("UI");
 
-    /* create widgets */
-    d->user_content = webkit_user_content_manager_new();
     d->view = g_object_new(WEBKIT_TYPE_WEB_VIEW,
                  "web-context", web_context_get(),
                  "is-ephemeral", d->private,
                  "user-content-manager", d->user_content,
+                 "settings", webview_get_settings(d),
                  related_view ? "related-view" : NULL, related_view,
                  NULL);
     d->inspector = webkit_web_view_get_inspector(d->view);
 
-    d->is_committed = FALSE;
-
-    /* Create a new endpoint with one ref (this webview) */
-    d->ipc = ipc_endpoint_new("UI");
-
-    w->widget = GTK_WIDGET(d->view);
-
-    /* insert data into global tables and arrays */
-    g_ptr_array_add(globalconf.webviews, w);
+    /* So that the widget_t can be found from WebKit callbacks */
+    g_object_set_data(G_OBJECT(d->view), GOBJECT_LUAKIT_WIDGET_DATA_KEY, w);
+    /* ...and from IPC messages */
+    d->page_id = webkit_web_view_get_page_id(d->view);
+    g_hash_table_insert(webviews_by_id, &d->page_id, w);
 
     g_object_connect(G_OBJECT(d->view),
-      LUAKIT_WIDGET_SIGNAL_COMMON(w)
+      "signal::focus-in-event",                       G_CALLBACK(focus_cb),                     w,
+      "signal::focus-out-event",                      G_CALLBACK(focus_cb),                     w,
       "signal::button-press-event",                   G_CALLBACK(webview_button_cb),            w,
       "signal::button-release-event",                 G_CALLBACK(webview_button_cb),            w,
       "signal::scroll-event",                         G_CALLBACK(webview_scroll_cb),            w,
@@ -1449,10 +1690,6 @@ widget_webview(lua_State *L, widget_t *w, luakit_token_t UNUSED(token))
       "signal::failed-to-find-text",                  G_CALLBACK(failed_to_find_text_cb),       w,
       NULL);
 
-    g_object_connect(G_OBJECT(d->view),
-      "signal::parent-set",                           G_CALLBACK(parent_set_cb),                w,
-      NULL);
-
     g_object_connect(G_OBJECT(d->inspector),
       "signal::attach",                               G_CALLBACK(inspector_attach_window_cb),   w,
       "signal::bring-to-front",                       G_CALLBACK(inspector_show_window_cb),     w,
@@ -1461,8 +1698,107 @@ widget_webview(lua_State *L, widget_t *w, luakit_token_t UNUSED(token))
       "signal::open-window",                          G_CALLBACK(inspector_open_window_cb),     w,
       NULL);
 
-    /* show widgets */
+    gtk_widget_set_can_focus(GTK_WIDGET(d->view), d->can_focus);
     gtk_widget_show(GTK_WIDGET(d->view));
+    gtk_box_pack_start(GTK_BOX(w->widget), GTK_WIDGET(d->view), TRUE, TRUE, 0);
+
+    /* Load the location set while the webview was a placeholder */
+    gboolean restored = FALSE;
+    if (d->pending_state) {
+        WebKitWebViewSessionState *state = webkit_web_view_session_state_new(d->pending_state);
+        restored = webview_restore_session_state(d, state);
+        webkit_web_view_session_state_unref(state);
+        g_bytes_unref(d->pending_state);
+        d->pending_state = NULL;
+    }
+    if (!restored && d->uri && g_strcmp0(d->uri, "about:blank"))
+        webkit_web_view_load_uri(d->view, d->uri);
+
+    g_free(d->title);
+    d->title = NULL;
+
+    if (!d->notify_placeholder)
+        return d->view;
+    d->notify_placeholder = FALSE;
+
+    lua_State *L = common.L;
+    luaH_object_push(L, w->ref);
+    luaH_object_property_signal(L, -1, L_TK_PLACEHOLDER);
+    lua_pop(L, 1);
+
+    return d->view;
+}
+
+widget_t *
+widget_webview(lua_State *L, widget_t *w, luakit_token_t UNUSED(token))
+{
+    w->index = luaH_webview_index;
+    w->newindex = luaH_webview_newindex;
+    w->destructor = webview_destructor;
+
+    /* create private webview data struct */
+    webview_data_t *d = g_slice_new0(webview_data_t);
+    d->widget = w;
+    w->data = d;
+
+    /* Determine whether webview should be ephemeral, and whether to create
+     * the webview widget only once it is first shown */
+    /* Lua stack: [{class meta}, {props}, new widget, "type", "webview"] */
+    gint prop_tbl_idx = luaH_absindex(L, -4);
+    g_assert(lua_istable(L, prop_tbl_idx));
+    lua_pushstring(L, "private");
+    lua_rawget(L, prop_tbl_idx);
+    gboolean private = lua_type(L, -1) == LUA_TNIL ? FALSE : lua_toboolean(L, -1);
+    lua_pop(L, 1);
+    d->private = private;
+    lua_pushstring(L, "placeholder");
+    lua_rawget(L, prop_tbl_idx);
+    gboolean placeholder = lua_toboolean(L, -1) && !related_view;
+    lua_pop(L, 1);
+
+    /* keep a list of all webview widgets */
+    if (!globalconf.webviews)
+        globalconf.webviews = g_ptr_array_new();
+    if (!webviews_by_id) {
+        webviews_by_id = g_hash_table_new(g_int64_hash, g_int64_equal);
+        ipc_set_flush_func(eval_js_batch_flush);
+    }
+
+    if (!globalconf.stylesheets)
+        globalconf.stylesheets = g_ptr_array_new();
+    d->stylesheets = NULL;
+
+    /* Set web process limits if not already set */
+    web_context_init_finish();
+
+    /* create widgets; the webview widget itself is packed into a container,
+     * so that it can be created later, along with its user content manager
+     * and IPC endpoint */
+    d->is_committed = FALSE;
+    d->can_focus = TRUE;
+
+    w->widget = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+
+    /* insert data into global tables and arrays */
+    g_ptr_array_add(globalconf.webviews, w);
+
+    g_object_connect(G_OBJECT(w->widget),
+      LUAKIT_WIDGET_SIGNAL_COMMON(w)
+      "signal::parent-set",                           G_CALLBACK(parent_set_cb),                w,
+      NULL);
+
+    /* Placeholders and discarded webviews are created when shown */
+    g_object_connect(G_OBJECT(w->widget),
+      "signal::map",                                  G_CALLBACK(webview_map_cb),               w,
+      NULL);
+
+    if (placeholder)
+        d->notify_placeholder = TRUE;
+    else
+        webview_ensure_view(w);
+
+    /* show widgets */
+    gtk_widget_show(w->widget);
 
     return w;
 }
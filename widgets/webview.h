@@ -30,6 +30,7 @@ widget_t* webview_get_by_id(guint64 view_id);
 void webview_connect_to_endpoint(widget_t *w, ipc_endpoint_t *ipc);
 void webview_set_web_process_id(widget_t *w, pid_t pid);
 ipc_endpoint_t * webview_get_endpoint(widget_t *w);
+GtkWidget* webview_get_web_view(widget_t *w, gboolean create);
 
 #endif
 
@@ -42,7 +42,7 @@ static void
 luakit_store_password(LuakitAuthData *auth_data, const gchar *login, const gchar *password)
 {
     lua_State *L = common.L;
-    const gchar *uri = webkit_web_view_get_uri(WEBKIT_WEB_VIEW(auth_data->w->widget));
+    const gchar *uri = webkit_web_view_get_uri(((webview_data_t*)auth_data->w->data)->view);
     luaH_object_push(L, auth_data->w->ref);
     lua_pushstring(L, uri);
     lua_pushstring(L, login);
@@ -55,7 +55,7 @@ static void
 luakit_find_password(LuakitAuthData *auth_data, const gchar **login, const gchar **password)
 {
     lua_State *L = common.L;
-    const gchar *uri = webkit_web_view_get_uri(WEBKIT_WEB_VIEW(auth_data->w->widget));
+    const gchar *uri = webkit_web_view_get_uri(((webview_data_t*)auth_data->w->data)->view);
     luaH_object_push(L, auth_data->w->ref);
     lua_pushstring(L, uri);
     gint ret = luaH_object_emit_signal(L, -2, "store-password", 1, LUA_MULTRET);
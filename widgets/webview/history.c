@@ -102,6 +102,22 @@ luaH_webview_go_forward(lua_State *L)
     return webview_history_go(L,  1);
 }
 
+/* Restore a session state and go to its current page; returns FALSE if the
+ * session state has no current page */
+static gboolean
+webview_restore_session_state(webview_data_t *d, WebKitWebViewSessionState *state)
+{
+    webkit_web_view_restore_session_state(d->view, state);
+
+    WebKitBackForwardList *bfl = webkit_web_view_get_back_forward_list(d->view);
+    WebKitBackForwardListItem *item = webkit_back_forward_list_get_current_item(bfl);
+    if (!item)
+        return FALSE;
+    webkit_web_view_go_to_back_forward_list_item(d->view, item);
+    update_uri(d->widget, webkit_back_forward_list_item_get_uri(item));
+    return TRUE;
+}
+
 static void
 luaH_webview_set_session_state(lua_State *L, webview_data_t *d)
 {
@@ -109,27 +125,40 @@ luaH_webview_set_session_state(lua_State *L, webview_data_t *d)
     const gchar *str = lua_tolstring(L, 3, &len);
     GBytes *bytes = g_bytes_new(str, len);
     WebKitWebViewSessionState *state = webkit_web_view_session_state_new(bytes);
-    g_bytes_unref(bytes);
-    if (!state)
+    if (!state) {
+        g_bytes_unref(bytes);
         luaL_error(L, "Invalid session state");
-    webkit_web_view_restore_session_state(d->view, state);
-    webkit_web_view_session_state_unref(state);
+    }
 
-    WebKitBackForwardList *bfl = webkit_web_view_get_back_forward_list(d->view);
-    WebKitBackForwardListItem *item = webkit_back_forward_list_get_current_item(bfl);
-    if (item) {
-        webkit_web_view_go_to_back_forward_list_item(d->view, item);
-        update_uri(d->widget, webkit_back_forward_list_item_get_uri(item));
+    if (d->view) {
+        webview_restore_session_state(d, state);
+        g_bytes_unref(bytes);
+    } else {
+        /* Restored when the webview widget is created */
+        if (d->pending_state)
+            g_bytes_unref(d->pending_state);
+        d->pending_state = bytes;
     }
+    webkit_web_view_session_state_unref(state);
 }
 
 static int
 luaH_webview_push_session_state(lua_State *L, webview_data_t *d)
 {
+    gsize len;
+    const gchar *str;
+
+    if (!d->view) {
+        if (!d->pending_state)
+            return 0;
+        str = g_bytes_get_data(d->pending_state, &len);
+        lua_pushlstring(L, str, len);
+        return 1;
+    }
+
     WebKitWebViewSessionState *state = webkit_web_view_get_session_state(d->view);
     GBytes *bytes = webkit_web_view_session_state_serialize(state);
-    gsize len;
-    const gchar *str = g_bytes_get_data(bytes, &len);
+    str = g_bytes_get_data(bytes, &len);
     lua_pushlstring(L, str, len);
     g_bytes_unref(bytes);
     webkit_web_view_session_state_unref(state);
@@ -25,16 +25,10 @@
 #include "common/ipc.h"
 #include "common/luaserialize.h"
 
-void
-run_javascript_finished(const guint8 *msg, guint length)
+static void
+run_javascript_finished_one(lua_State *L, gint n)
 {
-    lua_State *L = common.L;
-    gint top = lua_gettop(L);
-    gint n = lua_deserialize_range(L, msg, length);
-    g_assert_cmpint(n, >=, 2);
-    g_assert_cmpint(n, <=, 4);
     /* Lua stack: [page_id, cb], [page_id, cb, nil, err] or [page_id, cb, ret] */
-
     widget_t *w = webview_get_by_id(lua_tointeger(L, -n));
     lua_remove(L, -n);
     n--;
@@ -57,11 +51,124 @@ run_javascript_finished(const guint8 *msg, guint length)
     }
 
     if (w && cb) {
-        g_signal_handlers_disconnect_by_data(w->widget, cb);
+        g_signal_handlers_disconnect_by_data(((webview_data_t*)w->data)->view, cb);
         luaH_object_unref(L, cb);
     }
+}
+
+void
+run_javascript_finished(const guint8 *msg, guint length)
+{
+    lua_State *L = common.L;
+    gint top = lua_gettop(L);
+    gint n = lua_deserialize_range(L, msg, length);
+
+    /* A batch of replies, each [page_id, cb, nret, ret...] */
+    gint idx = top + 1;
+    while (idx <= top + n) {
+        gint nret = lua_tointeger(L, idx + 2);
+        g_assert_cmpint(nret, >=, 0);
+        g_assert_cmpint(nret, <=, 2);
+        gint base = lua_gettop(L);
+        lua_pushvalue(L, idx);
+        lua_pushvalue(L, idx + 1);
+        for (gint i = 0; i < nret; i++)
+            lua_pushvalue(L, idx + 3 + i);
+        run_javascript_finished_one(L, nret + 2);
+        lua_settop(L, base);
+        idx += 3 + nret;
+    }
+
+    lua_settop(L, top);
+}
+
+/** Scripts registered with luakit.register_js(); each entry holds the
+ * serialized registration message, so that web processes which start later
+ * can be sent it when their extension is initialized */
+static GHashTable *registered_js;
+static gint registered_js_next_id = 1;
+
+static void
+send_registered_js(gpointer UNUSED(id), GByteArray *msg, ipc_endpoint_t *ipc)
+{
+    ipc_header_t header = { .type = IPC_TYPE_js_register, .length = msg->len };
+    ipc_send(ipc, &header, msg->data);
+}
+
+void
+webview_register_js_on_endpoint(ipc_endpoint_t *ipc)
+{
+    if (registered_js)
+        g_hash_table_foreach(registered_js, (GHFunc)send_registered_js, ipc);
+}
+
+static void
+broadcast_registered_js(GByteArray *msg)
+{
+    const GPtrArray *endpoints = ipc_endpoints_get();
+    for (guint i = 0; i < endpoints->len; i++)
+        send_registered_js(NULL, msg, endpoints->pdata[i]);
+}
+
+gint
+luaH_luakit_register_js(lua_State *L)
+{
+    const gchar *script = luaL_checkstring(L, 1);
+    const gchar *source = NULL;
+    gint args_idx = 0;
+
+    gint top = lua_gettop(L);
+    if (top >= 2 && !lua_isnil(L, 2)) {
+        luaH_checktable(L, 2);
+        if (luaH_rawfield(L, 2, "source") && lua_isstring(L, -1))
+            source = lua_tostring(L, -1);
+        if (luaH_rawfield(L, 2, "args")) {
+            luaH_checktable(L, -1);
+            args_idx = lua_gettop(L);
+        }
+    }
+
+    gchar *caller = source ? NULL : luaH_callerinfo(L);
+    gint id = registered_js_next_id++;
 
+    /* Message: [id, script, source, argument names] */
+    lua_pushinteger(L, id);
+    lua_pushstring(L, script);
+    lua_pushstring(L, source ?: caller);
+    if (args_idx)
+        lua_pushvalue(L, args_idx);
+    else
+        lua_newtable(L);
+    GByteArray *msg = g_byte_array_new();
+    lua_serialize_range(L, msg, -4, -1);
     lua_settop(L, top);
+    g_free(caller);
+
+    if (!registered_js)
+        registered_js = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                NULL, (GDestroyNotify)g_byte_array_unref);
+    g_hash_table_insert(registered_js, GINT_TO_POINTER(id), msg);
+    broadcast_registered_js(msg);
+
+    lua_pushinteger(L, id);
+    return 1;
+}
+
+gint
+luaH_luakit_unregister_js(lua_State *L)
+{
+    gint id = luaL_checkinteger(L, 1);
+    if (!registered_js || !g_hash_table_remove(registered_js, GINT_TO_POINTER(id)))
+        return 0;
+
+    /* Message: [id] */
+    GByteArray *msg = g_byte_array_new();
+    lua_pushinteger(L, id);
+    lua_serialize_range(L, msg, -1, -1);
+    lua_pop(L, 1);
+    broadcast_registered_js(msg);
+    g_byte_array_unref(msg);
+    return 0;
 }
 
 static void
@@ -70,15 +177,61 @@ run_javascript_webview_closed(WebKitWebView *UNUSED(view), gpointer cb)
     luaH_object_unref(common.L, cb);
 }
 
+static gboolean
+eval_js_batch_send(widget_t *w)
+{
+    webview_data_t *d = w->data;
+    ipc_endpoint_remove_batched(d->ipc, w);
+    ipc_header_t header = { .type = IPC_TYPE_eval_js, .length = d->eval_js_batch->len };
+    ipc_send(d->ipc, &header, d->eval_js_batch->data);
+    g_byte_array_set_size(d->eval_js_batch, 0);
+    d->eval_js_batch_id = 0;
+    return FALSE;
+}
+
+/* Send the pending eval_js batch of a webview before another message to its
+ * endpoint, so that requests aren't reordered after messages sent to it
+ * directly */
+static void
+eval_js_batch_flush(ipc_endpoint_t *UNUSED(ipc), gpointer sender)
+{
+    widget_t *w = sender;
+    webview_data_t *d = w->data;
+    if (d->eval_js_batch_id) {
+        g_source_remove(d->eval_js_batch_id);
+        eval_js_batch_send(w);
+    }
+}
+
+/* Drop the pending eval_js batch of a webview */
+static void
+eval_js_batch_cancel(widget_t *w)
+{
+    webview_data_t *d = w->data;
+    if (d->eval_js_batch_id) {
+        g_source_remove(d->eval_js_batch_id);
+        d->eval_js_batch_id = 0;
+        ipc_endpoint_remove_batched(d->ipc, w);
+    }
+    if (d->eval_js_batch)
+        g_byte_array_set_size(d->eval_js_batch, 0);
+}
+
 static gint
 luaH_webview_eval_js(lua_State *L)
 {
     gpointer cb = NULL;
+    widget_t *w = luaH_checkwebview(L, 1);
     webview_data_t *d = luaH_checkwvdata(L, 1);
-    const gchar *script = luaL_checkstring(L, 2);
+    /* Either a script string, or a handle from luakit.register_js() */
+    gboolean compiled = lua_type(L, 2) == LUA_TNUMBER;
+    if (!compiled)
+        luaL_checkstring(L, 2);
     const gchar *usr_source = NULL;
     gchar *source = NULL;
     bool no_return = false;
+    gint args_idx = 0;
+    const gchar *format = "lua";
 
     luaH_checktable(L, 3);
 
@@ -88,22 +241,48 @@ luaH_webview_eval_js(lua_State *L)
         usr_source = lua_tostring(L, -1);
     if (luaH_rawfield(L, 3, "no_return"))
         no_return = lua_toboolean(L, -1);
+    if (luaH_rawfield(L, 3, "args")) {
+        luaH_checktable(L, -1);
+        args_idx = lua_gettop(L);
+    }
+    if (luaH_rawfield(L, 3, "format")) {
+        format = luaL_checkstring(L, -1);
+        if (strcmp(format, "lua") && strcmp(format, "json") && strcmp(format, "binary"))
+            return luaL_error(L, "unknown result format '%s'", format);
+    }
     if (luaH_rawfield(L, 3, "callback")) {
         luaH_checkfunction(L, -1);
         cb = luaH_object_ref(L, -1);
     }
-    lua_settop(L, top);
 
-    if (!usr_source)
+    if (!usr_source && !compiled)
         source = luaH_callerinfo(L);
 
+    /* Request: [no_return, script or handle, source, args, format, page_id, cb] */
     lua_pushboolean(L, no_return);
-    lua_pushstring(L, script);
-    lua_pushstring(L, usr_source ? g_strdup(usr_source) : source);
+    lua_pushvalue(L, 2);
+    lua_pushstring(L, usr_source ?: source);
+    if (args_idx && compiled)
+        lua_pushvalue(L, args_idx);
+    else
+        lua_pushnil(L);
+    lua_pushstring(L, format);
     lua_pushinteger(L, webkit_web_view_get_page_id(d->view));
     lua_pushlightuserdata(L, cb);
-    ipc_send_lua(d->ipc, IPC_TYPE_eval_js, L, -5, -1);
-    lua_pop(L, 5);
+
+    /* Requests made in the same main loop iteration are sent together, or
+     * earlier if another message is sent to the web process first */
+    if (!d->eval_js_batch)
+        d->eval_js_batch = g_byte_array_new();
+    lua_serialize_range(L, d->eval_js_batch, -7, -1);
+    if (!d->eval_js_batch_id) {
+        d->eval_js_batch_id = g_idle_add_full(G_PRIORITY_HIGH_IDLE,
+                (GSourceFunc)eval_js_batch_send, w, NULL);
+        ipc_endpoint_add_batched(d->ipc, w);
+    }
+
+    lua_settop(L, top);
+    g_free(source);
 
     if (cb)
         g_signal_connect(d->view, "destroy", G_CALLBACK(run_javascript_webview_closed), cb);
@@ -24,7 +24,7 @@ void
 webview_scroll_recv(widget_t *w, const ipc_scroll_t *msg)
 {
     webview_data_t *d = w->data;
-    if (webkit_web_view_get_page_id(d->view) != msg->page_id)
+    if (!d->view || webkit_web_view_get_page_id(d->view) != msg->page_id)
         return;
 
     switch (msg->subtype) {
@@ -71,7 +71,7 @@ luaH_webview_scroll_newindex(lua_State *L)
 static gint
 luaH_webview_scroll_index(lua_State *L)
 {
-    webview_data_t *d = luaH_checkwvdata(L, lua_upvalueindex(1));
+    webview_data_t *d = luaH_checkwebview(L, lua_upvalueindex(1))->data;
     const gchar *prop = luaL_checkstring(L, 2);
     luakit_token_t t = l_tokenize(prop);
 
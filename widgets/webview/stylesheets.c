@@ -35,6 +35,10 @@ void
 webview_stylesheets_regenerate(widget_t *w) {
     webview_data_t *d = w->data;
 
+    /* Placeholders are updated when their user content manager is created */
+    if (!d->user_content)
+        return;
+
     /* Re-add the user content manager stylesheets, if necessary
      * Always fully rebuild, because there's no remove_style_sheet(),
      * it's not currently easy to tell if a stylesheet has already been
@@ -67,9 +71,13 @@ webview_stylesheet_set_enabled(widget_t *w, lstylesheet_t *stylesheet, gboolean
     if (enable) {
         d->stylesheets = g_list_prepend(d->stylesheets, stylesheet);
         d->stylesheet_added = TRUE;
+        if (!stylesheet->webviews)
+            stylesheet->webviews = g_ptr_array_new();
+        g_ptr_array_add(stylesheet->webviews, w);
     } else {
-        d->stylesheets = g_list_remove_link(d->stylesheets, item);
+        d->stylesheets = g_list_delete_link(d->stylesheets, item);
         d->stylesheet_removed = TRUE;
+        g_ptr_array_remove_fast(stylesheet->webviews, w);
     }
 
     if (!inside_stylesheet_cb)
@@ -81,7 +89,7 @@ webview_stylesheet_set_enabled(widget_t *w, lstylesheet_t *stylesheet, gboolean
 static gint
 luaH_webview_stylesheets_index(lua_State *L)
 {
-    webview_data_t *d = luaH_checkwvdata(L, lua_upvalueindex(1));
+    webview_data_t *d = luaH_checkwebview(L, lua_upvalueindex(1))->data;
     lstylesheet_t *stylesheet = luaH_checkstylesheet(L, 2);
 
     gboolean enabled = g_list_find(d->stylesheets, stylesheet) != NULL;
@@ -93,7 +101,7 @@ luaH_webview_stylesheets_index(lua_State *L)
 static gint
 luaH_webview_stylesheets_newindex(lua_State *L)
 {
-    webview_data_t *d = luaH_checkwvdata(L, lua_upvalueindex(1));
+    webview_data_t *d = luaH_checkwebview(L, lua_upvalueindex(1))->data;
     lstylesheet_t *stylesheet = luaH_checkstylesheet(L, 2);
     gboolean enable = lua_toboolean(L, 3);
 
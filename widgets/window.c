@@ -25,6 +25,7 @@
 #include <gdk/gdkkeysyms.h>
 #include "luah.h"
 #include "widgets/common.h"
+#include "common/trace.h"
 
 typedef struct {
     widget_t *widget;
@@ -205,6 +206,18 @@ window_state_cb(GtkWidget* UNUSED(widget), GdkEventWindowState *ev, widget_t *w)
     return FALSE;
 }
 
+static gboolean
+first_draw_cb(GtkWidget *widget, cairo_t *UNUSED(cr), gpointer UNUSED(data))
+{
+    static gboolean painted;
+    if (!painted) {
+        painted = TRUE;
+        trace_milestone("first paint");
+    }
+    g_signal_handlers_disconnect_by_func(widget, first_draw_cb, NULL);
+    return FALSE;
+}
+
 static void
 window_destructor(widget_t *w)
 {
@@ -246,6 +259,9 @@ widget_window(lua_State *UNUSED(L), widget_t *w, luakit_token_t UNUSED(token))
       "signal::window-state-event", G_CALLBACK(window_state_cb), w,
       NULL);
 
+    if (trace_enabled)
+        g_signal_connect_after(w->widget, "draw", G_CALLBACK(first_draw_cb), NULL);
+
     d->id = ++window_id_next;
 
     /* add to global windows list */